@@ -0,0 +1,52 @@
+/*
+ * File:   AlignedBuffer.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace FileIO {
+
+/**
+ * Fixed size heap buffer with a guaranteed alignment, allocated with posix_memalign.
+ * Suitable as a reusable I/O buffer and for O_DIRECT transfers.
+ * If the allocation failed Valid() is false and Data() is nullptr
+ */
+class AlignedBuffer {
+public:
+   static const size_t kDefaultAlignment = 4096;
+
+   explicit AlignedBuffer(const size_t size, const size_t alignment = kDefaultAlignment)
+      : mMemory(nullptr, &free)
+      , mSize(0)
+      , mAlignment(alignment) {
+      void* memory = nullptr;
+      if (size > 0 && 0 == posix_memalign(&memory, alignment, size)) {
+         mMemory.reset(static_cast<uint8_t*>(memory));
+         mSize = size;
+      }
+   }
+
+   AlignedBuffer(AlignedBuffer&&) = default;
+   AlignedBuffer& operator=(AlignedBuffer&&) = default;
+   AlignedBuffer(const AlignedBuffer&) = delete;
+   AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+   bool Valid() const { return (nullptr != mMemory); }
+   uint8_t* Data() { return mMemory.get(); }
+   const uint8_t* Data() const { return mMemory.get(); }
+   size_t Size() const { return mSize; }
+   size_t Alignment() const { return mAlignment; }
+
+private:
+   std::unique_ptr<uint8_t, decltype(&free)> mMemory;
+   size_t mSize;
+   size_t mAlignment;
+};
+} // namespace FileIO
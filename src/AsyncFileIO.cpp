@@ -0,0 +1,98 @@
+/*
+ * File:   AsyncFileIO.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "AsyncFileIO.h"
+
+namespace {
+   /// MoveFile only tells if it worked
+   Result<bool> MoveFileResult(const std::string& source, const std::string& dest) {
+      if (!FileIO::MoveFile(source, dest)) {
+         return Result<bool>{false, {"Failed to move file: " + source + " to: " + dest}};
+      }
+      return Result<bool>{true};
+   }
+} // anonymous helper
+
+
+namespace FileIO {
+
+std::future<Result<std::vector<uint8_t>>> ReadBinaryFileContentAsync(const std::string& pathToFile, IOExecutor& executor) {
+   return RunAsync<std::vector<uint8_t>>(executor, [pathToFile] { return ReadBinaryFileContent(pathToFile); });
+}
+
+void ReadBinaryFileContentAsync(const std::string& pathToFile, Completion<std::vector<uint8_t>> done, IOExecutor& executor) {
+   RunAsync<std::vector<uint8_t>>(executor, [pathToFile] { return ReadBinaryFileContent(pathToFile); }, std::move(done));
+}
+
+std::future<Result<std::string>> ReadAsciiFileContentAsync(const std::string& pathToFile, IOExecutor& executor) {
+   return RunAsync<std::string>(executor, [pathToFile] { return ReadAsciiFileContent(pathToFile); });
+}
+
+void ReadAsciiFileContentAsync(const std::string& pathToFile, Completion<std::string> done, IOExecutor& executor) {
+   RunAsync<std::string>(executor, [pathToFile] { return ReadAsciiFileContent(pathToFile); }, std::move(done));
+}
+
+/// The content is moved into the task, pass it with std::move to avoid a copy
+std::future<Result<bool>> WriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, IOExecutor& executor) {
+   auto shared = std::make_shared<std::string>(std::move(content));
+   return RunAsync<bool>(executor, [pathToFile, shared] { return WriteAsciiFileContent(pathToFile, *shared); });
+}
+
+void WriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, Completion<bool> done, IOExecutor& executor) {
+   auto shared = std::make_shared<std::string>(std::move(content));
+   RunAsync<bool>(executor, [pathToFile, shared] { return WriteAsciiFileContent(pathToFile, *shared); }, std::move(done));
+}
+
+std::future<Result<bool>> AppendWriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, IOExecutor& executor) {
+   auto shared = std::make_shared<std::string>(std::move(content));
+   return RunAsync<bool>(executor, [pathToFile, shared] { return AppendWriteAsciiFileContent(pathToFile, *shared); });
+}
+
+void AppendWriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, Completion<bool> done, IOExecutor& executor) {
+   auto shared = std::make_shared<std::string>(std::move(content));
+   RunAsync<bool>(executor, [pathToFile, shared] { return AppendWriteAsciiFileContent(pathToFile, *shared); }, std::move(done));
+}
+
+std::future<Result<bool>> WriteAppendBinaryFileContentAsync(const std::string& filename, std::vector<uint8_t> content, IOExecutor& executor) {
+   auto shared = std::make_shared<std::vector<uint8_t>>(std::move(content));
+   return RunAsync<bool>(executor, [filename, shared] { return WriteAppendBinaryFileContent(filename, *shared); });
+}
+
+void WriteAppendBinaryFileContentAsync(const std::string& filename, std::vector<uint8_t> content, Completion<bool> done, IOExecutor& executor) {
+   auto shared = std::make_shared<std::vector<uint8_t>>(std::move(content));
+   RunAsync<bool>(executor, [filename, shared] { return WriteAppendBinaryFileContent(filename, *shared); }, std::move(done));
+}
+
+std::future<Result<bool>> WriteFileAtomicallyAsync(const std::string& pathToFile, std::string content, const Durability durability,
+                                                   IOExecutor& executor) {
+   auto shared = std::make_shared<std::string>(std::move(content));
+   return RunAsync<bool>(executor, [pathToFile, shared, durability] { return WriteFileAtomically(pathToFile, *shared, durability); });
+}
+
+void WriteFileAtomicallyAsync(const std::string& pathToFile, std::string content, const Durability durability, Completion<bool> done,
+                              IOExecutor& executor) {
+   auto shared = std::make_shared<std::string>(std::move(content));
+   RunAsync<bool>(executor, [pathToFile, shared, durability] { return WriteFileAtomically(pathToFile, *shared, durability); }, std::move(done));
+}
+
+std::future<Result<bool>> RemoveFileAsync(const std::string& filename, IOExecutor& executor) {
+   return RunAsync<bool>(executor, [filename] { return RemoveFile(filename); });
+}
+
+void RemoveFileAsync(const std::string& filename, Completion<bool> done, IOExecutor& executor) {
+   RunAsync<bool>(executor, [filename] { return RemoveFile(filename); }, std::move(done));
+}
+
+/// MoveFile reports failure as a Result with an error instead of false
+std::future<Result<bool>> MoveFileAsync(const std::string& source, const std::string& dest, IOExecutor& executor) {
+   return RunAsync<bool>(executor, [source, dest] { return MoveFileResult(source, dest); });
+}
+
+void MoveFileAsync(const std::string& source, const std::string& dest, Completion<bool> done, IOExecutor& executor) {
+   RunAsync<bool>(executor, [source, dest] { return MoveFileResult(source, dest); }, std::move(done));
+}
+} // namespace FileIO
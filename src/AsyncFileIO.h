@@ -0,0 +1,95 @@
+/*
+ * File:   AsyncFileIO.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <future>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <cstdint>
+#include "FileIO.h"
+#include "IOExecutor.h"
+#include "Result.h"
+
+/*
+ * Async versions of the FileIO read, write and move functions. They run the blocking
+ * function on an IOExecutor and either return a future or call a completion callback on
+ * the executor's thread. The result is the same as from the blocking function.
+ *
+ * An exception thrown by the work is reported as a failed Result, an exception thrown by a
+ * completion callback is dropped.
+ *
+ * When the executor does not take the work, see Backpressure, the future is ready at
+ * once, and the callback is called at once on the calling thread, with a failed Result.
+ */
+namespace FileIO {
+
+template<typename T>
+using Completion = std::function<void(const Result<T>& result)>;
+
+/// @return the result of the work, an exception thrown by the work becomes a failed Result
+template<typename T>
+Result<T> RunCatching(const std::function<Result<T>()>& work) {
+   try {
+      return work();
+   } catch (const std::exception& exception) {
+      return Result<T>{T{}, {std::string{"The I/O work failed with an exception: "} + exception.what()}};
+   } catch (...) {
+      return Result<T>{T{}, {"The I/O work failed with an unknown exception"}};
+   }
+}
+
+template<typename T>
+std::future<Result<T>> RunAsync(IOExecutor& executor, std::function<Result<T>()> work) {
+   auto task = std::make_shared<std::packaged_task<Result<T>()>>([work] { return RunCatching<T>(work); });
+   std::future<Result<T>> future = task->get_future();
+   if (!executor.Submit([task] { (*task)(); })) {
+      std::promise<Result<T>> rejected;
+      rejected.set_value(Result<T>{T{}, {"The I/O executor did not take the work, its queue is full or it is stopping"}});
+      return rejected.get_future();
+   }
+   return future;
+}
+
+template<typename T>
+void RunAsync(IOExecutor& executor, std::function<Result<T>()> work, Completion<T> done) {
+   auto run = [work, done] {
+      const Result<T> result = RunCatching<T>(work);
+      try {
+         done(result);
+      } catch (...) {
+         // a throwing completion must not take the executor's thread down
+      }
+   };
+   if (!executor.Submit(run)) {
+      done(Result<T>{T{}, {"The I/O executor did not take the work, its queue is full or it is stopping"}});
+   }
+}
+
+std::future<Result<std::vector<uint8_t>>> ReadBinaryFileContentAsync(const std::string& pathToFile, IOExecutor& executor = DefaultIOExecutor());
+void ReadBinaryFileContentAsync(const std::string& pathToFile, Completion<std::vector<uint8_t>> done, IOExecutor& executor = DefaultIOExecutor());
+std::future<Result<std::string>> ReadAsciiFileContentAsync(const std::string& pathToFile, IOExecutor& executor = DefaultIOExecutor());
+void ReadAsciiFileContentAsync(const std::string& pathToFile, Completion<std::string> done, IOExecutor& executor = DefaultIOExecutor());
+
+std::future<Result<bool>> WriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, IOExecutor& executor = DefaultIOExecutor());
+void WriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, Completion<bool> done, IOExecutor& executor = DefaultIOExecutor());
+std::future<Result<bool>> AppendWriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, IOExecutor& executor = DefaultIOExecutor());
+void AppendWriteAsciiFileContentAsync(const std::string& pathToFile, std::string content, Completion<bool> done, IOExecutor& executor = DefaultIOExecutor());
+std::future<Result<bool>> WriteAppendBinaryFileContentAsync(const std::string& filename, std::vector<uint8_t> content, IOExecutor& executor = DefaultIOExecutor());
+void WriteAppendBinaryFileContentAsync(const std::string& filename, std::vector<uint8_t> content, Completion<bool> done, IOExecutor& executor = DefaultIOExecutor());
+std::future<Result<bool>> WriteFileAtomicallyAsync(const std::string& pathToFile, std::string content, const Durability durability = Durability::DataSync,
+                                                   IOExecutor& executor = DefaultIOExecutor());
+void WriteFileAtomicallyAsync(const std::string& pathToFile, std::string content, const Durability durability, Completion<bool> done,
+                              IOExecutor& executor = DefaultIOExecutor());
+
+std::future<Result<bool>> RemoveFileAsync(const std::string& filename, IOExecutor& executor = DefaultIOExecutor());
+void RemoveFileAsync(const std::string& filename, Completion<bool> done, IOExecutor& executor = DefaultIOExecutor());
+std::future<Result<bool>> MoveFileAsync(const std::string& source, const std::string& dest, IOExecutor& executor = DefaultIOExecutor());
+void MoveFileAsync(const std::string& source, const std::string& dest, Completion<bool> done, IOExecutor& executor = DefaultIOExecutor());
+} // namespace FileIO
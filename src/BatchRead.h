@@ -0,0 +1,23 @@
+/*
+ * File:   BatchRead.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Result.h"
+
+namespace FileIO {
+
+struct BatchReadOptions {
+   unsigned queueDepth = 64;  ///< files that are read at the same time
+   size_t threads = 4;        ///< workers when io_uring is not available
+   bool useIoUring = true;    ///< false always uses the workers
+};
+
+std::vector<Result<std::string>> ReadFilesBatch(const std::vector<std::string>& paths, const BatchReadOptions& options = BatchReadOptions{});
+} // namespace FileIO
@@ -0,0 +1,182 @@
+/*
+ * File:   BinaryAppender.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "BinaryAppender.h"
+#include "FileIO.h"
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+/// @return the success of opening the file for appending
+auto AppenderInit = [](int* fd, const std::string& filename) -> Result<bool> {
+   *fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+   if (-1 == *fd) {
+      return Result<bool>{false, {"Unable to open file for appending: " + filename + ", error: " + std::strerror(errno)}};
+   }
+   return Result<bool>{true};
+};
+} // anonymous helper
+
+
+namespace FileIO {
+
+/**
+ * @param filename to append to. The file is created if it does not exist
+ * @param options flush and sync thresholds
+ */
+BinaryAppender::BinaryAppender(const std::string& filename, const AppenderOptions& options)
+   : mFilename(filename)
+   , mOptions(options)
+   , mFd(-1)
+   , mBuffer()
+   , mUnsyncedBytes(0)
+   , mFileSize(0)
+   , mReservedEnd(0)
+   , mOldestBuffered()
+   , mValid{AppenderInit(&mFd, filename)} {
+   mBuffer.reserve(mOptions.flushBytes);
+   struct stat fileInfo;
+   if (-1 != mFd && 0 == fstat(mFd, &fileInfo)) {
+      mFileSize = fileInfo.st_size;
+      mReservedEnd = fileInfo.st_size;
+   }
+}
+
+/// Flushes any buffered content and releases the unused reservation before the file is closed
+BinaryAppender::~BinaryAppender() {
+   if (-1 != mFd) {
+      Flush();
+      struct stat fileInfo;
+      if (mReservedEnd > mFileSize && 0 == fstat(mFd, &fileInfo)) {
+         ftruncate(mFd, fileInfo.st_size); // frees the blocks past the end of the file
+      }
+      close(mFd);
+   }
+}
+
+/// @return number of appended bytes that are not yet written to the file
+size_t BinaryAppender::BufferedBytes() const {
+   return mBuffer.size();
+}
+
+/**
+ * Append content to the file. Small content is buffered, content that does not
+ * fit in the buffer is written together with the buffered content in one writev
+ * call, without being copied to the buffer.
+ * @return Result<bool> whether or not the append (and any triggered write) was successful
+ */
+Result<bool> BinaryAppender::Append(const uint8_t* content, const size_t size) {
+   if (mValid.HasFailed()) {
+      return mValid;
+   }
+
+   if (mBuffer.size() + size > mOptions.flushBytes) {
+      return Write(content, size);
+   }
+
+   if (mBuffer.empty()) {
+      mOldestBuffered = std::chrono::steady_clock::now();
+   }
+   mBuffer.insert(mBuffer.end(), content, content + size);
+
+   const bool hasInterval = (mOptions.flushInterval.count() > 0);
+   if (hasInterval && (std::chrono::steady_clock::now() - mOldestBuffered) >= mOptions.flushInterval) {
+      return Flush();
+   }
+   return Result<bool>{true};
+}
+
+Result<bool> BinaryAppender::Append(const std::vector<uint8_t>& content) {
+   return Append(content.data(), content.size());
+}
+
+/**
+ * Write all buffered content to the file
+ * @return Result<bool> whether or not the write was successful
+ */
+Result<bool> BinaryAppender::Flush() {
+   if (mValid.HasFailed()) {
+      return mValid;
+   }
+   return Write(nullptr, 0);
+}
+
+/**
+ * Writes the buffered content followed by the given content. Whatever was buffered
+ * is discarded also on failure, the error reports that the data could not be written
+ */
+Result<bool> BinaryAppender::Write(const uint8_t* content, const size_t size) {
+   struct iovec buffers[2];
+   int count = 0;
+   if (!mBuffer.empty()) {
+      buffers[count].iov_base = mBuffer.data();
+      buffers[count].iov_len = mBuffer.size();
+      ++count;
+   }
+   if (size > 0) {
+      buffers[count].iov_base = const_cast<uint8_t*>(content);
+      buffers[count].iov_len = size;
+      ++count;
+   }
+
+   const size_t writtenBytes = mBuffer.size() + size;
+   Reserve(writtenBytes);
+   const int error = WriteVectored(mFd, buffers, count);
+   mBuffer.clear();
+   mFileSize += writtenBytes;
+   if (0 != error) {
+      struct stat fileInfo;
+      if (0 == fstat(mFd, &fileInfo)) {
+         mFileSize = fileInfo.st_size; // part of it may have been written
+      }
+      return Result<bool>{false, {"Unable to write to file: " + mFilename + ", error: " + std::strerror(error)}};
+   }
+   return Sync(writtenBytes);
+}
+
+/**
+ * Reserves AppenderOptions::preallocateBytes past the end of the file when the next write
+ * does not fit in what was reserved before. A file system without fallocate just does not
+ * get the reservation, the write is not affected
+ */
+void BinaryAppender::Reserve(const size_t bytes) {
+   if (0 == mOptions.preallocateBytes || mFileSize + static_cast<off_t> (bytes) <= mReservedEnd) {
+      return;
+   }
+   const size_t reserve = std::max(mOptions.preallocateBytes, bytes);
+   PreallocateRange(mFd, mFileSize, reserve, PreallocateMode::KeepSize);
+   mReservedEnd = mFileSize + static_cast<off_t> (reserve);
+}
+
+/// fdatasync according to the sync policy
+Result<bool> BinaryAppender::Sync(const size_t writtenBytes) {
+   mUnsyncedBytes += writtenBytes;
+   bool sync = false;
+   switch (mOptions.syncPolicy) {
+      case SyncPolicy::EveryFlush: sync = (mUnsyncedBytes > 0);
+         break;
+      case SyncPolicy::EveryNBytes: sync = (mUnsyncedBytes >= mOptions.syncBytes);
+         break;
+      case SyncPolicy::Never:
+      default:
+         sync = false;
+   }
+
+   if (sync) {
+      mUnsyncedBytes = 0;
+      if (0 != fdatasync(mFd)) {
+         return Result<bool>{false, {"fdatasync failed for file: " + mFilename + ", error: " + std::strerror(errno)}};
+      }
+   }
+   return Result<bool>{true};
+}
+} // namespace FileIO
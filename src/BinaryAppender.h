@@ -0,0 +1,78 @@
+/*
+ * File:   BinaryAppender.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <sys/types.h>
+#include "Result.h"
+
+namespace FileIO {
+
+/// When the appended data is forced to disk with fdatasync
+enum class SyncPolicy {Never, EveryNBytes, EveryFlush};
+
+struct AppenderOptions {
+   size_t flushBytes = 1024 * 1024; ///< buffered bytes that trigger a write
+   std::chrono::milliseconds flushInterval{1000}; ///< max age of buffered data, zero disables it
+   SyncPolicy syncPolicy = SyncPolicy::Never;
+   size_t syncBytes = 64 * 1024 * 1024; ///< written bytes between fdatasync for SyncPolicy::EveryNBytes
+   size_t preallocateBytes = 0; ///< disk space reserved ahead of the writes with fallocate, zero disables it
+};
+
+/**
+ * Long-lived appender for high rate writes of small records. The file is kept
+ * open and appended content is coalesced in memory, it is written with one
+ * writev call when
+ *    1. the buffered content reaches AppenderOptions::flushBytes
+ *    2. the oldest buffered content is older than AppenderOptions::flushInterval.
+ *       The age is checked at Append, no background thread is involved
+ *    3. Flush() is called or the appender goes out of scope
+ *
+ * With AppenderOptions::preallocateBytes the blocks past the end of the file are reserved
+ * before they are written, so that a file that grows slowly still gets large contiguous
+ * extents. What is left of the reservation is released when the appender is closed,
+ * this assumes that nobody else appends to the file meanwhile
+ *
+ * A BinaryAppender is not thread-safe, use one per thread or protect it with a mutex
+ */
+class BinaryAppender {
+public:
+   explicit BinaryAppender(const std::string& filename, const AppenderOptions& options = AppenderOptions{});
+   ~BinaryAppender();
+
+   Result<bool> Valid() const {
+      return mValid;
+   }
+
+   Result<bool> Append(const uint8_t* content, const size_t size);
+   Result<bool> Append(const std::vector<uint8_t>& content);
+   Result<bool> Flush();
+   size_t BufferedBytes() const;
+
+   BinaryAppender() = delete;
+   BinaryAppender(const BinaryAppender&) = delete;
+   BinaryAppender& operator=(const BinaryAppender&) = delete;
+
+private:
+   Result<bool> Write(const uint8_t* content, const size_t size);
+   Result<bool> Sync(const size_t writtenBytes);
+   void Reserve(const size_t bytes);
+
+   const std::string mFilename;
+   const AppenderOptions mOptions;
+   int mFd;
+   std::vector<uint8_t> mBuffer;
+   size_t mUnsyncedBytes;
+   off_t mFileSize;
+   off_t mReservedEnd; ///< end of the blocks reserved with fallocate
+   std::chrono::steady_clock::time_point mOldestBuffered;
+   Result<bool> mValid;
+};
+} // namespace FileIO
@@ -0,0 +1,47 @@
+/*
+ * File:   DirectoryListing.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <sys/types.h>
+#include "DirectoryReader.h"
+#include "Result.h"
+
+namespace FileIO {
+
+/// Order of the listed entries
+enum class ListingOrder {
+   Unsorted,         ///< as the file system returns them
+   Name,
+   ModificationTime, ///< oldest first
+   Size,             ///< smallest first
+   Inode             ///< by inode number, see ListDirectory
+};
+
+struct ListingOptions {
+   bool filesOnly = true;   ///< only regular files, like GetDirectoryContents
+   std::string suffix;      ///< only names that end with the suffix, e.g. ".log"
+   std::string glob;        ///< only names that match the fnmatch pattern, e.g. "spool_*.dat"
+   std::function<bool(const DirectoryEntry& entry)> predicate; ///< only entries it returns true for
+   ListingOrder order = ListingOrder::Name;
+   bool withStat = false;   ///< fill in size and modification time also when the order does not need them
+};
+
+/// A listed entry. size and modifiedNs are only filled in when the entries were stat'ed
+struct ListedEntry {
+   std::string name;
+   EntryType type;
+   ino64_t inode;
+   off_t size;
+   int64_t modifiedNs;  ///< modification time in nanoseconds since the epoch
+};
+
+Result<std::vector<ListedEntry>> ListDirectory(const std::string& directory, const ListingOptions& options = ListingOptions{});
+} // namespace FileIO
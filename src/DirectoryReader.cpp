@@ -7,25 +7,38 @@
  */
 
 #include "DirectoryReader.h"
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <cerrno>
 
 /**
  * Helper lambda to instantiate the const Result<bool> AFTER
- * the opendir call.
+ * the open call.
  */
 namespace {
-/// @return the success of the opendir operation
-auto DirectoryInit = [](DIR** directory, const std::string pathToDirectory) -> Result<bool> {
-   *directory = opendir(pathToDirectory.c_str());
-   std::string error{""};
+/// @return the success of opening the directory and allocating the entry buffer
+auto DirectoryInit = [](int* fd, const std::string pathToDirectory, const FileIO::AlignedBuffer& buffer) -> Result<bool> {
+   if (!buffer.Valid()) {
+      return Result<bool> {false, {"Failed to allocate the directory buffer for: " + pathToDirectory}};
+   }
 
-   if (nullptr == *directory) {
+   *fd = open(pathToDirectory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (-1 == *fd) {
       std::string error{std::strerror(errno)};
       return Result<bool> {false, error};
    }
    return Result<bool>(true);
 };
+
+/// @return true for "." and ".."
+bool IsDotOrDotDot(const char* name) {
+   return ('.' == name[0] && ('\0' == name[1] || ('.' == name[1] && '\0' == name[2])));
+}
 } // anonymous helper
 
 
@@ -36,12 +49,111 @@ namespace FileIO {
 
 
 
-DirectoryReader::DirectoryReader(const std::string& pathToDirectory)
-   : mDirectory {nullptr }
-   , mValid{DirectoryInit(&mDirectory, pathToDirectory)}{}
+/**
+ * @param pathToDirectory to read
+ * @param bufferSize for the getdents64 calls, i.e. how many entries are read per system call
+ * @param resolveUnknownTypes statx entries that are reported as DT_UNKNOWN to find their type
+ */
+DirectoryReader::DirectoryReader(const std::string& pathToDirectory, const size_t bufferSize, const bool resolveUnknownTypes)
+   : mFd {-1}
+   , mBuffer(std::max(bufferSize, sizeof(struct dirent64)))
+   , mBufferEnd {0}
+   , mPosition {0}
+   , mEnd {false}
+   , mResolveUnknownTypes {resolveUnknownTypes}
+   , mReadError {0}
+   , mValid{DirectoryInit(&mFd, pathToDirectory, mBuffer)}{}
 
 DirectoryReader::~DirectoryReader() {
-   closedir(mDirectory);
+   if (-1 != mFd) {
+      close(mFd);
+   }
+}
+
+/**
+ * Reads the next batch of entries into the buffer
+ * @return false at the end of the directory or on failure, errno is set on failure
+ */
+bool DirectoryReader::Fill() {
+   mPosition = 0;
+   mBufferEnd = 0;
+   if (mEnd || -1 == mFd) {
+      return false;
+   }
+
+   long bytes = -1;
+   do {
+      bytes = syscall(SYS_getdents64, mFd, mBuffer.Data(), mBuffer.Size());
+   } while (-1 == bytes && EINTR == errno);
+
+   if (bytes <= 0) {
+      mReadError = (-1 == bytes) ? errno : 0;
+      mEnd = true;
+      return false;
+   }
+   mBufferEnd = static_cast<size_t>(bytes);
+   return true;
+}
+
+/**
+ * statx relative to the directory, only the type is requested. Symbolic links are not followed
+ * @return the d_type of the entry, DT_UNKNOWN if it could not be found
+ */
+unsigned char DirectoryReader::ResolveType(const char* name) const {
+   struct statx info;
+   if (0 == statx(mFd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, STATX_TYPE, &info) && (info.stx_mask & STATX_TYPE)) {
+      return IFTODT(info.stx_mode);
+   }
+   return DT_UNKNOWN;
+}
+
+/**
+ * Finds the next entry in the directory without copying the name or allocating any memory.
+ * The directories "." and ".." are skipped
+ *
+ * @param entry to fill in. Its name is valid until the next call to Next() or Reset()
+ * @return false when the end is reached, ReadError() tells if reading the directory failed
+ */
+bool DirectoryReader::Next(DirectoryEntryView& entry) {
+   while (true) {
+      if (mPosition >= mBufferEnd && !Fill()) {
+         return false;
+      }
+
+      const auto* record = reinterpret_cast<const struct dirent64*>(mBuffer.Data() + mPosition);
+      mPosition += record->d_reclen;
+      if (IsDotOrDotDot(record->d_name)) {
+         continue;
+      }
+
+      entry.name = record->d_name;
+      entry.nameLength = std::strlen(record->d_name);
+      entry.type = record->d_type;
+      entry.inode = record->d_ino;
+      if (DT_UNKNOWN == entry.type && mResolveUnknownTypes) {
+         entry.type = ResolveType(record->d_name);
+      }
+      return true;
+   }
+}
+
+/**
+ * Finds the next entry in the directory, with the name, the type and the inode number.
+ * The name is assigned to the entry's string so a reused entry keeps its capacity.
+ * The directories "." and ".." are skipped
+ *
+ * @param entry to fill in
+ * @return false when the end is reached, ReadError() tells if reading the directory failed
+ */
+bool DirectoryReader::Next(DirectoryEntry& entry) {
+   DirectoryEntryView view;
+   if (!Next(view)) {
+      return false;
+   }
+   entry.name.assign(view.name, view.nameLength);
+   entry.type = static_cast<EntryType>(view.type);
+   entry.inode = view.inode;
+   return true;
 }
 
 /**
@@ -57,36 +169,28 @@ DirectoryReader::~DirectoryReader() {
  *
  */
 DirectoryReader::Entry DirectoryReader::Next() {
-   static const std::string Ignore1{"."};
-   static const std::string Ignore2{".."};
-
-   Entry entry = std::make_pair(FileType::Unknown, "");
-   bool found = false;
-   while (!found && (entry.first != FileType::End)) {
-      readdir64_r(mDirectory, &mEntry, &mResult); // readdir_r is reentrant
-
-      found = true; // abort immediately unless we hit "." or ".."
-
-      if (nullptr == mResult) {
-         entry = std::make_pair(FileType::End, "");
-      } else if (static_cast<unsigned char> (FileType::Directory) == mEntry.d_type) {
-         std::string name{mEntry.d_name};
-         if ((Ignore1 == name) || (Ignore2 == name)) {
-            found = false;
-         } else {
-            entry = std::make_pair(FileType::Directory, std::move(name));
-         }
-      } else if (static_cast<unsigned char> (FileType::File) == mEntry.d_type) {
-         entry = std::make_pair(FileType::File, mEntry.d_name);
-      } else {
-         // Default case. Unless continue was called it will always exit here
-         entry = std::make_pair(FileType::Unknown, "");
-      }
+   DirectoryEntryView view;
+   if (!Next(view)) {
+      return std::make_pair(FileType::End, "");
    }
-   return entry;
+
+   if (static_cast<unsigned char> (FileType::Directory) == view.type) {
+      return std::make_pair(FileType::Directory, std::string(view.name, view.nameLength));
+   } else if (static_cast<unsigned char> (FileType::File) == view.type) {
+      return std::make_pair(FileType::File, std::string(view.name, view.nameLength));
+   }
+   // Default case. Unknown types do not expose their name
+   return std::make_pair(FileType::Unknown, "");
 }
+
 /** Resets the position of the directory stream to the beginning of the directory */
 void DirectoryReader::Reset() {
-   rewinddir(mDirectory);
+   if (-1 != mFd) {
+      lseek(mFd, 0, SEEK_SET);
+   }
+   mPosition = 0;
+   mBufferEnd = 0;
+   mEnd = false;
+   mReadError = 0;
+}
 }
-}
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <Result.h>
 #include <dirent.h>
 #include <pwd.h>
+#include "AlignedBuffer.h"
 
 namespace FileIO {
 
@@ -23,21 +24,80 @@ namespace FileIO {
 **/
 enum class FileType : unsigned char {Unknown = DT_UNKNOWN, Directory = DT_DIR, File = DT_REG, End = DT_WHT + 1};
 
+/// Every d_type, the values correspond to the DT_ values in /usr/include/dirent.h
+enum class EntryType : unsigned char {
+   Unknown = DT_UNKNOWN, Fifo = DT_FIFO, CharacterDevice = DT_CHR, Directory = DT_DIR,
+   BlockDevice = DT_BLK, File = DT_REG, SymbolicLink = DT_LNK, Socket = DT_SOCK, Whiteout = DT_WHT
+};
+
+/**
+ * One directory entry with its own copy of the name, see DirectoryReader::Next(DirectoryEntry&).
+ * Symbolic links, devices, FIFOs and sockets keep their name and type, unlike
+ * DirectoryReader::Entry which maps them all to FileType::Unknown
+ */
+struct DirectoryEntry {
+   std::string name;
+   EntryType type;
+   ino64_t inode;
+};
+
+/**
+ * One directory entry as seen by DirectoryReader::Next(DirectoryEntryView&). The name
+ * points into the reader's buffer and is only valid until the next call to the reader.
+ * It is null terminated, nameLength excludes the terminator
+ */
+struct DirectoryEntryView {
+   const char* name;
+   size_t nameLength;
+   unsigned char type;  ///< d_type, DT_REG, DT_DIR, DT_LNK, ... or DT_UNKNOWN
+   ino64_t inode;       ///< d_ino
+};
+
+/**
+ * Reads a directory with getdents64 into a reusable buffer, many entries per system call.
+ * Next(DirectoryEntryView&) hands out the entries without any allocation, Next() is the
+ * original interface that returns the name as a std::string.
+ *
+ * The default buffer matches what readdir uses, a large buffer (e.g. 256KB) pays off for
+ * directories with millions of entries
+ *
+ * Some file systems (e.g. XFS without ftype, older network file systems) report DT_UNKNOWN
+ * for every entry. With resolveUnknownTypes the reader asks statx for the type of those
+ * entries only, entries with a known type never cost a stat
+ */
 struct DirectoryReader {
    typedef std::pair<FileType, std::string> Entry;
-   explicit DirectoryReader(const std::string& pathToDirectory);
+   static const size_t kDefaultBufferSize = 32 * 1024;
+
+   explicit DirectoryReader(const std::string& pathToDirectory, const size_t bufferSize = kDefaultBufferSize,
+                            const bool resolveUnknownTypes = false);
    ~DirectoryReader();
 
    Result<bool> Valid() {
       return mValid;
    }
    DirectoryReader::Entry Next();
+   bool Next(DirectoryEntryView& entry);
+   bool Next(DirectoryEntry& entry);
    void Reset();
+   int ReadError() const {
+      return mReadError;
+   }
+
+   DirectoryReader(const DirectoryReader&) = delete;
+   DirectoryReader& operator=(const DirectoryReader&) = delete;
 
  private:
-   DIR* mDirectory;
-   struct dirent64 mEntry;
-   struct dirent64* mResult;
+   bool Fill();
+   unsigned char ResolveType(const char* name) const;
+
+   int mFd;
+   AlignedBuffer mBuffer;
+   size_t mBufferEnd;    ///< bytes returned by the last getdents64 call
+   size_t mPosition;     ///< offset of the next entry in the buffer
+   bool mEnd;            ///< the end is sticky until Reset()
+   const bool mResolveUnknownTypes;
+   int mReadError;       ///< errno of a failed getdents64 call, zero if none failed
    Result<bool> mValid;
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,130 @@
+/*
+ * File:   FileChunkReader.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "FileChunkReader.h"
+#include "FileIO.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+/// @return the success of opening the file and allocating the chunk buffer
+auto ChunkReaderInit = [](int* fd, const std::string& pathToFile, const FileIO::AlignedBuffer& buffer) -> Result<bool> {
+   if (!buffer.Valid()) {
+      return Result<bool>{false, {"Failed to allocate chunk buffer for: " + pathToFile}};
+   }
+
+   *fd = open(pathToFile.c_str(), O_RDONLY | O_CLOEXEC);
+   if (-1 == *fd) {
+      return Result<bool>{false, {"Cannot read-open file: " + pathToFile + ", error: " + std::strerror(errno)}};
+   }
+
+   // The whole file is read front to back: let the kernel use aggressive readahead.
+   // Advice is only a hint, it is ignored for pipes and similar
+   posix_fadvise(*fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+   return Result<bool>{true};
+};
+} // anonymous helper
+
+
+namespace FileIO {
+
+/**
+ * @param pathToFile to read
+ * @param chunkSize size of the reusable read buffer, i.e. the maximum size of each chunk
+ */
+FileChunkReader::FileChunkReader(const std::string& pathToFile, const size_t chunkSize)
+   : mPathToFile(pathToFile)
+   , mFd(-1)
+   , mOffset(0)
+   , mBuffer(chunkSize)
+   , mValid{ChunkReaderInit(&mFd, pathToFile, mBuffer)} {}
+
+FileChunkReader::~FileChunkReader() {
+   if (-1 != mFd) {
+      close(mFd);
+   }
+}
+
+/// @return the content of the chunk read by the last call to Next()
+const uint8_t* FileChunkReader::Data() const {
+   return mBuffer.Data();
+}
+
+/**
+ * Reads the next chunk into the chunk buffer, the chunk is available through Data()
+ * until the next call to Next(). Every chunk except the last one is of full chunk size.
+ * When the chunk is read the kernel is asked to start reading the following chunk.
+ *
+ * @return Result<size_t> size of the chunk, zero when the end of the file is reached
+ */
+Result<size_t> FileChunkReader::Next() {
+   if (mValid.HasFailed()) {
+      return Result<size_t>{0, mValid.error};
+   }
+   if (Interrupted()) {
+      return Result<size_t>{0, {"Interrupted while reading: " + mPathToFile}};
+   }
+
+   size_t chunkSize = 0;
+   while (chunkSize < mBuffer.Size()) {
+      ssize_t rc = read(mFd, mBuffer.Data() + chunkSize, mBuffer.Size() - chunkSize);
+      if (-1 == rc) {
+         if (EINTR == errno) {
+            continue;
+         }
+         return Result<size_t>{0, {"Failed to read file: " + mPathToFile + ", error: " + std::strerror(errno)}};
+      }
+      if (0 == rc) {
+         break; // EOF
+      }
+      chunkSize += static_cast<size_t>(rc);
+   }
+
+   mOffset += chunkSize;
+   if (chunkSize == mBuffer.Size()) {
+      readahead(mFd, mOffset, mBuffer.Size()); // a hint only, fails for non regular files
+   }
+   return Result<size_t>{chunkSize};
+}
+
+/**
+ * Reads the whole file, chunk by chunk, and calls the handler for every chunk.
+ * It will stop when the handler returns a non-zero value, when Interrupted()
+ * is signaled or when the end of the file is reached.
+ *
+ * @param handler called with each chunk. The chunk memory is only valid during the call
+ * @return Result<size_t> number of bytes handed to the handler and any possible error
+ */
+Result<size_t> FileChunkReader::Action(ChunkHandler handler) {
+   size_t totalBytes = 0;
+   while (true) {
+      auto chunk = Next();
+      if (chunk.HasFailed()) {
+         return Result<size_t>{totalBytes, chunk.error};
+      }
+      if (0 == chunk.result) {
+         break;
+      }
+
+      totalBytes += chunk.result;
+      if (0 != handler(Data(), chunk.result)) {
+         break;
+      }
+   }
+   return Result<size_t>{totalBytes};
+}
+
+/** Restarts the reading at the beginning of the file */
+void FileChunkReader::Reset() {
+   if (-1 != mFd) {
+      lseek(mFd, 0, SEEK_SET);
+      mOffset = 0;
+   }
+}
+} // namespace FileIO
@@ -0,0 +1,59 @@
+/*
+ * File:   FileChunkReader.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <sys/types.h>
+#include "AlignedBuffer.h"
+#include "Result.h"
+
+namespace FileIO {
+
+/**
+ * Streams a file in fixed size chunks through one reusable buffer. Memory use is
+ * bounded by the chunk size regardless of the file size.
+ *
+ * Example usage:
+   @verbatim
+   FileIO::FileChunkReader reader(path, 1024 * 1024);
+   auto result = reader.Action([&](const uint8_t* chunk, size_t size) {
+      checksum.update(chunk, size);
+      return 0; // zero means continue with the next chunk
+   });
+   @endverbatim
+ */
+class FileChunkReader {
+public:
+   typedef std::function<int(const uint8_t* chunk, size_t size)> ChunkHandler;
+   static const size_t kDefaultChunkSize = 1024 * 1024;
+
+   explicit FileChunkReader(const std::string& pathToFile, const size_t chunkSize = kDefaultChunkSize);
+   ~FileChunkReader();
+
+   Result<bool> Valid() const {
+      return mValid;
+   }
+
+   Result<size_t> Next();
+   const uint8_t* Data() const;
+   Result<size_t> Action(ChunkHandler handler);
+   void Reset();
+
+   FileChunkReader() = delete;
+   FileChunkReader(const FileChunkReader&) = delete;
+   FileChunkReader& operator=(const FileChunkReader&) = delete;
+
+private:
+   const std::string mPathToFile;
+   int mFd;
+   off_t mOffset;
+   AlignedBuffer mBuffer;
+   Result<bool> mValid;
+};
+} // namespace FileIO
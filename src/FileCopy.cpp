@@ -0,0 +1,394 @@
+/*
+ * File:   FileCopy.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "FileCopy.h"
+#include "FileIO.h"
+#include "AlignedBuffer.h"
+#include "UncachedIO.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+/// Kernel copy strategies, in the order they are tried
+enum class Engine {CopyFileRange, Sendfile, Buffered};
+
+/// Each kernel call copies at most one slice, Interrupted() is checked between slices
+const size_t kSliceBytes = 64 * 1024 * 1024;
+const size_t kBufferedBytes = 1024 * 1024;
+
+/**
+ * Reports progress to the CopyOptions::progressHandler and throttles the copy
+ * to CopyProgress::maxBytesPerSecond by sleeping between slices
+ */
+class CopyPacer {
+public:
+   CopyPacer(const FileIO::CopyOptions& options, const size_t totalBytes)
+      : mOptions(options)
+      , mProgress{0, totalBytes, 0.0, options.maxBytesPerSecond}
+      , mBytesSinceReport(0)
+      , mLastReport(std::chrono::steady_clock::now())
+      , mThrottleStart(mLastReport)
+      , mThrottledBytes(0) {}
+
+   /// @return how much to copy with each kernel call
+   size_t SliceBytes() const {
+      size_t slice = kSliceBytes;
+      if (mOptions.progressHandler) {
+         slice = std::min(slice, std::max(mOptions.progressBytes, size_t{4096}));
+      }
+      if (mProgress.maxBytesPerSecond > 0) {
+         // about ten slices per second keeps the throttling smooth
+         slice = std::min(slice, std::max(mProgress.maxBytesPerSecond / 10, size_t{64 * 1024}));
+      }
+      return slice;
+   }
+
+   /**
+    * Account for copied (or skipped) bytes, sleep if the copy is ahead of the
+    * throttle and call the progress handler when it is due
+    * @return false if the progress handler cancelled the copy
+    */
+   bool Advance(const size_t bytes, const bool throttle) {
+      mProgress.bytesDone += bytes;
+      mBytesSinceReport += bytes;
+      if (throttle && mProgress.maxBytesPerSecond > 0) {
+         mThrottledBytes += bytes;
+         const std::chrono::duration<double> expected(double(mThrottledBytes) / mProgress.maxBytesPerSecond);
+         const auto elapsed = std::chrono::steady_clock::now() - mThrottleStart;
+         if (expected > elapsed) {
+            std::this_thread::sleep_for(expected - elapsed);
+         }
+      }
+
+      if (mOptions.progressHandler && mBytesSinceReport >= mOptions.progressBytes) {
+         return Report();
+      }
+      return true;
+   }
+
+   /// Final progress report, so that the handler always sees bytesDone == totalBytes
+   bool Finish() {
+      if (mOptions.progressHandler && (mBytesSinceReport > 0 || 0 == mProgress.totalBytes)) {
+         return Report();
+      }
+      return true;
+   }
+
+private:
+   bool Report() {
+      const auto now = std::chrono::steady_clock::now();
+      const std::chrono::duration<double> seconds = now - mLastReport;
+      mProgress.bytesPerSecond = (seconds.count() > 0) ? mBytesSinceReport / seconds.count() : 0.0;
+      const size_t previousLimit = mProgress.maxBytesPerSecond;
+
+      const int status = mOptions.progressHandler(mProgress);
+      if (previousLimit != mProgress.maxBytesPerSecond) {
+         mThrottleStart = std::chrono::steady_clock::now(); // new limit, new baseline
+         mThrottledBytes = 0;
+      }
+      mLastReport = now;
+      mBytesSinceReport = 0;
+      return (0 == status);
+   }
+
+   const FileIO::CopyOptions& mOptions;
+   FileIO::CopyProgress mProgress;
+   size_t mBytesSinceReport;
+   std::chrono::steady_clock::time_point mLastReport;
+   std::chrono::steady_clock::time_point mThrottleStart;
+   size_t mThrottledBytes;
+};
+
+/// @return the first engine after the given one that the options allow, the buffered copy is always allowed
+Engine NextEngine(const Engine engine, const FileIO::CopyOptions& options) {
+   if (Engine::CopyFileRange == engine && options.allowSendfile) {
+      return Engine::Sendfile;
+   }
+   return Engine::Buffered;
+}
+
+/// @return true if the error means that the strategy is not supported for these files
+bool NotSupported(const int error) {
+   return (EXDEV == error || ENOSYS == error || EINVAL == error || EOPNOTSUPP == error || EBADF == error);
+}
+
+/**
+ * Copies [offset, offset + length) from source to destination, at the same offset.
+ * The engine is downgraded in place when a strategy is not supported so that the
+ * following ranges do not retry it. An in-kernel copy that stops before the end of the
+ * range is retried with the next engine, some file systems return 0 from copy_file_range
+ * where they cannot copy. With a writeBehind the copied range is dropped from
+ * the page cache, on the source at once and on the destination once it is written back
+ * @return zero on success, otherwise errno. ECANCELED if the copy was interrupted or cancelled,
+ *         ENODATA if the source ended before the range, it was truncated while copying
+ */
+int CopyRange(const int source, const int dest, const off_t offset, const size_t length,
+              Engine& engine, const FileIO::CopyOptions& options, FileIO::CopyReport& report, CopyPacer& pacer,
+              FileIO::WriteBehind* writeBehind) {
+   off_t position = offset;
+   size_t remaining = length;
+   std::unique_ptr<FileIO::AlignedBuffer> buffer;
+
+   while (remaining > 0) {
+      if (FileIO::Interrupted()) {
+         return ECANCELED;
+      }
+
+      const size_t slice = std::min(remaining, pacer.SliceBytes());
+      ssize_t copied = -1;
+      switch (engine) {
+         case Engine::CopyFileRange: {
+            loff_t in = position;
+            loff_t out = position;
+            copied = copy_file_range(source, &in, dest, &out, slice, 0);
+            break;
+         }
+         case Engine::Sendfile: {
+            // sendfile writes at the current destination offset
+            off_t in = position;
+            if (-1 == lseek(dest, position, SEEK_SET)) {
+               return errno;
+            }
+            copied = sendfile(dest, source, &in, slice);
+            break;
+         }
+         case Engine::Buffered:
+         default: {
+            if (!buffer) {
+               buffer.reset(new FileIO::AlignedBuffer(kBufferedBytes));
+               if (!buffer->Valid()) {
+                  return ENOMEM;
+               }
+            }
+            copied = pread(source, buffer->Data(), std::min(slice, buffer->Size()), position);
+            if (copied > 0) {
+               struct iovec chunk{buffer->Data(), static_cast<size_t>(copied)};
+               if (-1 == lseek(dest, position, SEEK_SET)) {
+                  return errno;
+               }
+               const int error = FileIO::WriteVectored(dest, &chunk, 1);
+               if (0 != error) {
+                  return error;
+               }
+            }
+            break;
+         }
+      }
+
+      if (-1 == copied) {
+         const int error = errno;
+         if (EINTR == error) {
+            continue;
+         }
+         if (Engine::Buffered != engine && NotSupported(error)) {
+            engine = NextEngine(engine, options);
+            continue;
+         }
+         return error;
+      }
+
+      if (0 == copied) {
+         if (Engine::Buffered != engine) {
+            engine = NextEngine(engine, options);
+            continue;
+         }
+         return ENODATA;
+      }
+
+      switch (engine) {
+         case Engine::CopyFileRange: report.copyFileRangeBytes += copied;
+            break;
+         case Engine::Sendfile: report.sendfileBytes += copied;
+            break;
+         case Engine::Buffered:
+         default: report.bufferedBytes += copied;
+      }
+      if (nullptr != writeBehind) {
+         posix_fadvise(source, position, copied, POSIX_FADV_DONTNEED);
+         writeBehind->Written(position, copied);
+      }
+      position += copied;
+      remaining -= copied;
+      if (!pacer.Advance(copied, true)) {
+         return ECANCELED;
+      }
+   }
+   return 0;
+}
+} // anonymous helper
+
+
+namespace FileIO {
+
+/**
+ * Copy a file, using the cheapest mechanism the file systems support:
+ *   1. FICLONE reflink: the copy shares the extents with the source (XFS, btrfs). No data is copied
+ *   2. copy_file_range: in-kernel copy, may be offloaded to the storage
+ *   3. sendfile: in-kernel copy
+ *   4. pread/pwrite through a user space buffer
+ * copy_file_range and sendfile can be turned off in the CopyOptions.
+ * Sparse source files stay sparse: only the ranges reported by SEEK_DATA/SEEK_HOLE are copied.
+ * A source that is truncated while it is copied fails the copy with ENODATA, the missing
+ * data is never replaced with zeros.
+ *
+ * The destination is created with the permissions of the source, an existing destination
+ * is truncated. The copy stops with an error if Interrupted() is signaled
+ *
+ * The optional CopyOptions::progressHandler is called every CopyOptions::progressBytes
+ * and when the copy is done. It can cancel the copy by returning non-zero and it can
+ * change the throttle, CopyProgress::maxBytesPerSecond, at any time
+ *
+ * Unless the source is sparse the destination is preallocated to the size of the source
+ * first, so that the copy gets contiguous extents, see CopyOptions::preallocate.
+ * With CopyOptions::dropCacheBehind the copy does not stay in the page cache, neither the
+ * source nor the destination. A reflink copies no data and is not affected
+ *
+ * @param sourcePath regular file to copy
+ * @param destPath where to put the copy
+ * @param options reflink and sparse file handling, progress reporting, throttling and caching
+ * @return Result<CopyReport> with the number of bytes copied by each strategy. On failure
+ *         errno is set and the error string contains the reason, a destination that was
+ *         created or truncated is removed
+ */
+Result<CopyReport> CopyFile(const std::string& sourcePath, const std::string& destPath, const CopyOptions& options) {
+   CopyReport report;
+   bool destCreated = false; ///< the destination was created or truncated, a failed copy removes it
+   auto Failure = [&](const std::string& step, const int error) {
+      if (destCreated) {
+         unlink(destPath.c_str());
+      }
+      errno = error;
+      return Result<CopyReport>{report, {step + " failed when copying: " + sourcePath + " to " + destPath + ", error: " + std::strerror(error)}};
+   };
+
+   ScopedFileDescriptor source(sourcePath, O_RDONLY | O_CLOEXEC, 0);
+   if (-1 == source.fd) {
+      return Failure("open source", errno);
+   }
+
+   struct stat sourceStat;
+   if (0 != fstat(source.fd, &sourceStat)) {
+      return Failure("fstat", errno);
+   }
+   if (!S_ISREG(sourceStat.st_mode)) {
+      return Failure("not a regular file", EINVAL);
+   }
+
+   struct stat destStat;
+   if (0 == stat(destPath.c_str(), &destStat) && destStat.st_dev == sourceStat.st_dev && destStat.st_ino == sourceStat.st_ino) {
+      return Failure("source and destination are the same file", EINVAL);
+   }
+
+   const mode_t permissions = sourceStat.st_mode & 07777;
+   ScopedFileDescriptor dest(destPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, permissions);
+   if (-1 == dest.fd) {
+      return Failure("open destination", errno);
+   }
+   destCreated = true;
+   // close reports write back errors on NFS and FUSE, it is part of the copy
+   auto CloseDestination = [&] {
+      const int rcClose = close(dest.fd);
+      dest.fd = -1;
+      return (0 == rcClose) ? 0 : errno;
+   };
+   if (0 != fchmod(dest.fd, permissions)) { // open's permissions are filtered by umask
+      return Failure("fchmod", errno);
+   }
+
+   const off_t size = sourceStat.st_size;
+   CopyPacer pacer(options, size);
+   if (options.allowReflink && size > 0 && 0 == ioctl(dest.fd, FICLONE, source.fd)) {
+      report.reflinkBytes = size;
+      pacer.Advance(size, false);
+      const int closeError = CloseDestination();
+      if (0 != closeError) {
+         return Failure("close destination", closeError);
+      }
+      pacer.Finish();
+      return Result<CopyReport>{report};
+   }
+
+   // a sparse source is copied sparse, reserving all of its size would fill the holes
+   const bool sparseSource = (static_cast<off_t> (sourceStat.st_blocks) * 512 < size);
+   if (options.preallocate && !(options.preserveSparse && sparseSource)) {
+      PreallocateRange(dest.fd, 0, size, PreallocateMode::KeepSize); // only a hint, the copy works without it
+   }
+
+   std::unique_ptr<WriteBehind> writeBehind;
+   if (options.dropCacheBehind) {
+      posix_fadvise(source.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      writeBehind.reset(new WriteBehind(dest.fd));
+   }
+   Engine engine = options.allowCopyFileRange ? Engine::CopyFileRange : NextEngine(Engine::CopyFileRange, options);
+   bool sparse = options.preserveSparse;
+   off_t position = 0;
+   while (position < size) {
+      off_t dataStart = position;
+      off_t dataEnd = size;
+      if (sparse) {
+         dataStart = lseek(source.fd, position, SEEK_DATA);
+         if (-1 == dataStart && ENXIO == errno) {
+            dataStart = size; // only a hole is left
+         } else if (-1 == dataStart) {
+            sparse = false; // SEEK_DATA is not supported, copy everything
+            dataStart = position;
+         } else {
+            dataEnd = lseek(source.fd, dataStart, SEEK_HOLE);
+            dataEnd = (-1 == dataEnd) ? size : std::min(dataEnd, size);
+         }
+      }
+
+      const size_t holeBytes = std::min(dataStart, size) - position;
+      report.holeBytes += holeBytes;
+      if (!pacer.Advance(holeBytes, false)) {
+         return Failure("copy", ECANCELED);
+      }
+      if (dataStart >= size) {
+         break;
+      }
+
+      const int error = CopyRange(source.fd, dest.fd, dataStart, dataEnd - dataStart, engine, options, report, pacer, writeBehind.get());
+      if (0 != error) {
+         return Failure("copy", error);
+      }
+      position = dataEnd;
+   }
+
+   if (writeBehind) {
+      writeBehind->Finish();
+   }
+   // a source that shrank after the first ranges reads as a hole, it must not be padded with zeros
+   struct stat copiedStat;
+   if (0 != fstat(source.fd, &copiedStat)) {
+      return Failure("fstat", errno);
+   }
+   if (copiedStat.st_size < size) {
+      return Failure("copy", ENODATA);
+   }
+
+   // trailing holes are not written, the size is set explicitly
+   if (0 != ftruncate(dest.fd, size)) {
+      return Failure("ftruncate", errno);
+   }
+   const int closeError = CloseDestination();
+   if (0 != closeError) {
+      return Failure("close destination", closeError);
+   }
+   pacer.Finish();
+   return Result<CopyReport>{report};
+}
+} // namespace FileIO
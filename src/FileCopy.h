@@ -0,0 +1,53 @@
+/*
+ * File:   FileCopy.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <cstddef>
+#include <functional>
+#include "Result.h"
+
+namespace FileIO {
+
+/// Progress of an ongoing copy, handed to the CopyOptions::progressHandler
+struct CopyProgress {
+   size_t bytesDone;          ///< copied bytes and skipped holes so far
+   size_t totalBytes;         ///< size of the file
+   double bytesPerSecond;     ///< rate since the previous progress call
+   size_t maxBytesPerSecond;  ///< throttle, the handler can change it. Zero means no limit
+};
+
+/// Called during the copy, return non-zero to cancel the copy
+typedef std::function<int(CopyProgress& progress)> CopyProgressHandler;
+
+struct CopyOptions {
+   bool allowReflink = true;    ///< try to share the extents with FICLONE before copying any data
+   bool preserveSparse = true;  ///< skip holes found with SEEK_DATA/SEEK_HOLE
+   bool allowCopyFileRange = true; ///< copy in the kernel with copy_file_range
+   bool allowSendfile = true;   ///< copy in the kernel with sendfile, the user space copy is always allowed
+   CopyProgressHandler progressHandler; ///< optional, see CopyProgress
+   size_t progressBytes = 64 * 1024 * 1024; ///< how many bytes between calls to the progress handler
+   size_t maxBytesPerSecond = 0; ///< throttle for the copy, zero means no limit
+   bool preallocate = true;     ///< fallocate the destination to the size of the source before copying
+   bool dropCacheBehind = false; ///< drop the copied ranges of both files from the page cache as the copy goes
+};
+
+/// Bytes copied by each of the copy strategies
+struct CopyReport {
+   size_t reflinkBytes = 0;
+   size_t copyFileRangeBytes = 0;
+   size_t sendfileBytes = 0;
+   size_t bufferedBytes = 0;
+   size_t holeBytes = 0;        ///< bytes of the file that were holes and not copied
+
+   size_t CopiedBytes() const {
+      return reflinkBytes + copyFileRangeBytes + sendfileBytes + bufferedBytes;
+   }
+};
+
+Result<CopyReport> CopyFile(const std::string& sourcePath, const std::string& destPath, const CopyOptions& options = CopyOptions{});
+} // namespace FileIO
@@ -15,24 +15,46 @@
 #include <sys/fsuid.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #include <pwd.h>
 #include "DirectoryReader.h"
+#include "MappedFile.h"
+#include "FileCopy.h"
 #include "Result.h"
 #include <functional>
 #include <mutex>
 #include <memory>
 
 namespace FileIO {
+/// How far WriteFileAtomically forces the new content to disk, see WriteFileAtomically
+enum class Durability {None, DataSync, FullSync};
+/// Whether PreallocateFile grows the file size or only reserves the blocks, see PreallocateFile
+enum class PreallocateMode {Extend, KeepSize};
+
+struct MoveOptions {
+   size_t threads = 4; ///< workers that copy the files that could not be renamed
+};
+
 void SetInterruptFlag(volatile int* interrupted = nullptr);
 bool Interrupted();
 Result<bool> IsMountPoint(const std::string& pathToDirectory);
 Result<std::vector<uint8_t>> ReadBinaryFileContent(const std::string& pathToFile);
 Result<std::string> ReadAsciiFileContent(const std::string& pathToFile);
+Result<bool> ReadBinaryFileContentInto(const std::string& pathToFile, std::vector<uint8_t>& content);
+Result<bool> ReadAsciiFileContentInto(const std::string& pathToFile, std::string& content);
 
 Result<bool> WriteAppendBinaryFileContent(const std::string& filename, const std::vector<uint8_t>& content);
 Result<bool> WriteAsciiFileContent(const std::string& pathToFile, const std::string& content);
 Result<bool> AppendWriteAsciiFileContent(const std::string& pathToFile, const std::string& content);
 Result<bool> WriteFileContentInternal(const std::string& pathToFile, const std::string& content, std::ios_base::openmode mode);
+Result<bool> WriteFileAtomically(const std::string& pathToFile, const std::string& content, const Durability durability = Durability::DataSync);
+Result<bool> WriteFileAtomicallyInternal(const std::string& pathToFile, const std::string& content, const Durability durability,
+                                         const std::function<void(const int fd)>& beforeWrite);
+Result<bool> WriteGather(const std::string& pathToFile, const struct iovec* buffers, const size_t count);
+Result<bool> AppendGather(const std::string& pathToFile, const struct iovec* buffers, const size_t count);
+int WriteVectored(const int fd, const struct iovec* buffers, const size_t count);
+Result<bool> PreallocateFile(const std::string& pathToFile, const size_t bytes, const PreallocateMode mode = PreallocateMode::KeepSize);
+int PreallocateRange(const int fd, const off_t offset, const size_t bytes, const PreallocateMode mode);
 
 Result<bool> ChangeFileOrDirOwnershipToUser(const std::string& path, const std::string& username);
 bool DoesFileExist(const std::string& pathToFile);
@@ -42,11 +64,15 @@ bool DoesDirectoryHaveContent(const std::string& pathToDirectory) ;
 Result<bool> CleanDirectoryOfFileContents(const std::string& location, size_t& filesRemoved, std::vector<std::string>& foundDirectories);
 Result<bool> CleanDirectory(const std::string& directory, const bool removeDirectory, size_t& filesRemoved);
 Result<bool> CleanDirectory(const std::string& directory, const bool removeDirectory);
+Result<bool> CleanDirectory(const std::string& directory, const bool removeDirectory, size_t& filesRemoved, const size_t threads);
 Result<bool> RemoveEmptyDirectories(const std::vector<std::string>& fullPathDirectories);
 Result<bool> RemoveFile(const std::string& filename);
 bool MoveFile(const std::string& source, const std::string& dest);
+bool MoveFileWithProgress(const std::string& source, const std::string& dest, const CopyOptions& options);
+std::vector<Result<bool>> MoveFiles(const std::vector<std::pair<std::string, std::string>>& sourceAndDest, const MoveOptions& options = MoveOptions{});
 
 Result<std::vector<std::string>> GetDirectoryContents(const std::string& directory);
+Result<bool> GetDirectoryContentsInto(const std::string& directory, std::vector<std::string>& filesInDirectory);
 
 struct passwd* GetUserFromPasswordFile(const std::string& username);
 void SetUserFileSystemAccess(const std::string& username);
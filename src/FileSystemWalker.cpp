@@ -14,31 +14,146 @@
 
 
 namespace {
-   struct ScopedFts {
-      FTS* mFts;
+   /**
+    * fts_open arguments:
+    *      FTS_PHYSICAL: Symbolic links will NOT be followed
+    *      FTS_XDEV : will not go to a different mount point then the starting point
+    *      FTS_NOCHDIR: IMPORTANT:   This flag is needed for thread safety. 
+    *                    Internally it will NOT do any chdir calls with this flag, 
+    *                    but it will slow down the execution a bit
+    *      FTS_NOSTAT: optional, see WalkOptions::noStat
+    *      nullptr     : no specific ordering is made for returning the results
+    * Reference: http://man7.org/linux/man-pages/man3/fts.3.html
+    */
+   Result<bool> OpenFts(FTS** fts, const std::string& startPath, const WalkOptions& options) {
+      if (!FileIO::DoesDirectoryExist(startPath)) {
+         return Result<bool>{false, {"Invalid Path: " + startPath}};
+      }
+
+      char* rawpath = const_cast<char*> (startPath.c_str());
+      char* ftsRawPath[] = {rawpath, nullptr}; // convert path to "char* const* "
+      const int noStat = options.noStat ? FTS_NOSTAT : 0;
+      *fts = fts_open(ftsRawPath, FTS_PHYSICAL | FTS_XDEV | FTS_NOCHDIR | noStat, nullptr);
+      if (nullptr == *fts) {
+         return Result<bool>{false, {"Could not open filesystem at: " + startPath}};
+      }
+      return Result<bool>{true};
+   }
+}
+
+/**
+ * @param startPath to traverse the directory at
+ * @param options depth limit, order and FTS_NOSTAT, see WalkOptions
+ */
+WalkCursor::WalkCursor(const std::string& startPath, const WalkOptions& options)
+: mStartPath(startPath)
+, mOptions(options)
+, mFts(nullptr)
+, mCurrent(nullptr)
+, mValid{OpenFts(&mFts, startPath, options)} {
+}
+
+WalkCursor::WalkCursor(WalkCursor&& other)
+: mStartPath(other.mStartPath)
+, mOptions(other.mOptions)
+, mFts(other.mFts)
+, mCurrent(other.mCurrent)
+, mValid(other.mValid) {
+   other.mFts = nullptr;
+   other.mCurrent = nullptr;
+}
 
-      explicit ScopedFts(FTS* fts) : mFts(fts) { }
+WalkCursor::~WalkCursor() {
+   if (nullptr != mFts) {
+      fts_close(mFts);
+   }
+}
 
-      ~ScopedFts() {
-         fts_close(mFts);
+/// @return true if the entry should be handed out according to the order. Applies the depth limit
+bool WalkCursor::Wanted(FTSENT* node) {
+   const int info = node->fts_info;
+   if (FTS_D == info) {
+      if (mOptions.maxDepth >= 0 && node->fts_level >= mOptions.maxDepth) {
+         fts_set(mFts, node, FTS_SKIP);
       }
+      return (WalkOrder::PostOrder != mOptions.order);
+   }
+   if (FTS_DP == info) {
+      return (WalkOrder::PreOrder != mOptions.order);
+   }
+   return true;
+}
 
-      ScopedFts() = delete;
-      ScopedFts(const FileSystemWalker&) = delete;
-      ScopedFts& operator=(const FileSystemWalker&) = delete;
+/**
+ * Reads the next entry. If the previous entry was a directory in preorder that was
+ * marked with FileSystemWalker::SkipSubtree its subtree is skipped.
+ *
+ * @return the next entry, nullptr when the walk is done. The entry is valid until the
+ *         next call to Next(), see Current()
+ */
+FTSENT* WalkCursor::Next() {
+   if (nullptr == mFts) {
+      return nullptr;
+   }
+   if (nullptr != mCurrent && FTS_D == mCurrent->fts_info && FileSystemWalker::kSkipSubtree == mCurrent->fts_number) {
+      fts_set(mFts, mCurrent, FTS_SKIP);
+   }
 
-   };
+   while ((mCurrent = fts_read(mFts)) != nullptr) {
+      if (mOptions.noStat) {
+         // FTS_NOSTAT: fts does not allocate stat buffers, fts_statp is left uninitialized
+         mCurrent->fts_statp = nullptr;
+      }
+      if (Wanted(mCurrent)) {
+         return mCurrent;
+      }
+   }
+   return nullptr;
 }
 
 /**
  * @param startPath to traverse the directory at
  * @param ftsHandler a function that takes FTSENT* and flag of filetype for file system processing
  */
-FileSystemWalker::FileSystemWalker(const std::string& startPath, std::function<int(FTSENT*, int) > ftsHandler) \
+FileSystemWalker::FileSystemWalker(const std::string& startPath, std::function<int(FTSENT*, int) > ftsHandler, const WalkOptions& options) \
 : mFtsHandler(ftsHandler)
-, mStartPath(startPath) {
+, mStartPath(startPath)
+, mOptions(options) {
  }
 
+/**
+ * Called by the handler for a directory in preorder (FTS_D): the walker will not read
+ * the directory, none of its entries are handed to the handler. The directory itself
+ * is still handed to the handler in postorder (FTS_DP)
+ * @param directory the FTSENT the handler was called with
+ */
+void FileSystemWalker::SkipSubtree(FTSENT* directory) {
+   directory->fts_number = kSkipSubtree;
+}
+
+/**
+ * Stat for an entry, for walks with WalkOptions::noStat. The stat that fts already did
+ * is used when there is one, otherwise it costs an lstat
+ * @param node the FTSENT the handler was called with
+ * @param info filled in with the stat of the entry. Symbolic links are not followed
+ * @return false if the entry could not be stat'ed, errno is set
+ */
+bool FileSystemWalker::Stat(const FTSENT* node, struct stat& info) {
+   switch (node->fts_info) {
+      case FTS_NSOK:
+         return (0 == lstat(node->fts_path, &info));
+      case FTS_NS:
+         errno = node->fts_errno;
+         return false;
+      default:
+         if (nullptr == node->fts_statp) {
+            return (0 == lstat(node->fts_path, &info));
+         }
+         info = *node->fts_statp;
+         return true;
+   }
+}
+
 
 /**
  * @return true if the directory exist
@@ -91,29 +206,14 @@ bool FileSystemWalker::IsValid() const {
   @endvarbatim
  */
 Result<int> FileSystemWalker::Action() {
-   if (!IsValid()) {
-      return Result<int>{-1, {"Invalid Path: " + mStartPath}};
-   }
-   char* rawpath = const_cast<char*> (mStartPath.c_str());
-   char* ftsRawPath[] = {rawpath, nullptr}; // convert path to "char* const* "
-
-   // fts_open arguments:
-   //      FTS_PHYSICAL: Symbolic links will NOT be followed
-   //      FTS_XDEV : will not go to a different mount point then the starting point
-   //      FTS_NOCHDIR: IMPORTANT:   This flag is needed for thread safety. 
-   //                    Internally it will NOT do any chdir calls with this flag, 
-   //                    but it will slow down the execution a bit
-   //      nullptr     : no specific ordering is made for returning the results
-   // Reference: http://man7.org/linux/man-pages/man3/fts.3.html
-   FTS* file_system = fts_open(ftsRawPath, FTS_PHYSICAL | FTS_XDEV | FTS_NOCHDIR, nullptr);
-   if (nullptr == file_system) {
-      return Result<int>{-1, {"Could not open filesystem at: " + mStartPath}};
+   WalkCursor cursor(mStartPath, mOptions);
+   if (cursor.Valid().HasFailed()) {
+      return Result<int>{-1, cursor.Valid().error};
    }
 
-   ScopedFts cleanup(file_system);
    FTSENT* node = nullptr;
    int status = 0;
-   while ((0 == status) && (node = fts_read(file_system)) != nullptr) {
+   while ((0 == status) && (node = cursor.Next()) != nullptr) {
       int info = node->fts_info;
       status = mFtsHandler(node, info);
    }
@@ -10,17 +10,71 @@
 #include <string>
 #include <functional>
 #include <fts.h>
+#include <sys/stat.h>
 #include "Result.h"
 
+/// Which visits of a directory are handed out: preorder (FTS_D), postorder (FTS_DP) or both
+enum class WalkOrder {PreOrder, PostOrder, Both};
+
+struct WalkOptions {
+   /// FTS_NOSTAT: entries that d_type shows are not directories are not stat'ed, they are
+   /// handed to the handler as FTS_NSOK. Use FileSystemWalker::Stat when the stat is needed
+   bool noStat = false;
+   WalkOrder order = WalkOrder::Both;
+   /// Directories at this depth are handed out but not read, the start path is at depth 0.
+   /// Negative means no limit
+   int maxDepth = -1;
+};
+
+/*
+ * WalkCursor is the pull-style walk that FileSystemWalker is built on: every call to Next()
+ * returns the next entry. The walk can be stopped at any entry and resumed later by calling
+ * Next() again, see also WalkRange.h for iterators over a cursor.
+ * The same fts flags as FileSystemWalker are used.
+ */
+class WalkCursor {
+public:
+   explicit WalkCursor(const std::string& startPath, const WalkOptions& options = WalkOptions{});
+   ~WalkCursor();
+   WalkCursor(WalkCursor&& other);
+
+   Result<bool> Valid() const {
+      return mValid;
+   }
+   FTSENT* Next();
+   FTSENT* Current() const {
+      return mCurrent;
+   }
+
+   WalkCursor() = delete;
+   WalkCursor(const WalkCursor&) = delete;
+   WalkCursor& operator=(const WalkCursor&) = delete;
+   WalkCursor& operator=(WalkCursor&&) = delete;
+private:
+   bool Wanted(FTSENT* node);
+
+   const std::string mStartPath;
+   const WalkOptions mOptions;
+   FTS* mFts;
+   FTSENT* mCurrent;
+   Result<bool> mValid;
+};
+
 /*
  * FileSystemWalker is used in a similar way to the c-libraries "ftw, nftw, nftw64" but is thread-safe. 
  */
 class FileSystemWalker {
 public:
-   FileSystemWalker(const std::string& startPath, std::function<int(FTSENT*, int ftstype_flag) > ftsHandler);
+   FileSystemWalker(const std::string& startPath, std::function<int(FTSENT*, int ftstype_flag) > ftsHandler,
+                    const WalkOptions& options = WalkOptions{});
    bool IsValid() const;
    Result<int> Action();
 
+   /// fts_number of a directory whose subtree the handler asked to skip, see SkipSubtree
+   static const long kSkipSubtree = 2;
+   static void SkipSubtree(FTSENT* directory);
+   static bool Stat(const FTSENT* node, struct stat& info);
+
    FileSystemWalker() = delete;
    FileSystemWalker(const FileSystemWalker&) = delete;
    FileSystemWalker& operator=(const FileSystemWalker&) = delete;   
@@ -28,5 +82,6 @@ private:
    
    std::function<int(FTSENT*, int) > mFtsHandler;
    const std::string mStartPath;
+   const WalkOptions mOptions;
 };
 
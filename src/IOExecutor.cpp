@@ -0,0 +1,117 @@
+/*
+ * File:   IOExecutor.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "IOExecutor.h"
+#include <algorithm>
+
+namespace {
+   std::mutex gDefaultLock;
+   FileIO::ExecutorOptions gDefaultOptions;
+   /// Never deleted: joining its threads during static destruction would run the queued
+   /// tasks after the statics they use are gone, and deadlock a task that calls exit()
+   FileIO::IOExecutor* gDefaultExecutor = nullptr;
+} // anonymous helper
+
+
+namespace FileIO {
+
+/// @param options threads, queue capacity and what to do when the queue is full
+IOExecutor::IOExecutor(const ExecutorOptions& options)
+   : mOptions(options)
+   , mStop(false) {
+   const size_t workers = std::max(options.threads, size_t{1});
+   for (size_t index = 0; index < workers; ++index) {
+      mWorkers.emplace_back(&IOExecutor::Run, this);
+   }
+}
+
+/// Runs the tasks that are already queued, then stops the threads. Later submits are rejected
+IOExecutor::~IOExecutor() {
+   {
+      std::lock_guard<std::mutex> lock(mLock);
+      mStop = true;
+   }
+   mNotEmpty.notify_all();
+   mNotFull.notify_all();
+   for (auto& worker : mWorkers) {
+      worker.join();
+   }
+}
+
+/**
+ * Queues a task to run on one of the executor's threads
+ * @return false if the task was not queued: the queue is full and Backpressure::Reject
+ *         is used, or the executor is stopping
+ */
+bool IOExecutor::Submit(Task task) {
+   std::unique_lock<std::mutex> lock(mLock);
+   const size_t capacity = std::max(mOptions.queueCapacity, size_t{1});
+   if (Backpressure::Block == mOptions.whenFull) {
+      mNotFull.wait(lock, [&] { return mStop || mQueue.size() < capacity; });
+   }
+   if (mStop || mQueue.size() >= capacity) {
+      return false;
+   }
+   mQueue.push_back(std::move(task));
+   lock.unlock();
+   mNotEmpty.notify_one();
+   return true;
+}
+
+/// @return tasks waiting for a thread
+size_t IOExecutor::Queued() const {
+   std::lock_guard<std::mutex> lock(mLock);
+   return mQueue.size();
+}
+
+void IOExecutor::Run() {
+   while (true) {
+      Task task;
+      {
+         std::unique_lock<std::mutex> lock(mLock);
+         mNotEmpty.wait(lock, [&] { return mStop || !mQueue.empty(); });
+         if (mQueue.empty()) {
+            return; // stopping and drained
+         }
+         task = std::move(mQueue.front());
+         mQueue.pop_front();
+      }
+      mNotFull.notify_one();
+      try {
+         task();
+      } catch (...) {
+         // an exception must not take the thread down, the task reports its own errors
+      }
+   }
+}
+
+/**
+ * Sets the options of the default executor. It only has effect before the default executor
+ * is first used, by DefaultIOExecutor() or by an async function without an executor
+ * @return false if the default executor already exists
+ */
+bool ConfigureDefaultIOExecutor(const ExecutorOptions& options) {
+   std::lock_guard<std::mutex> lock(gDefaultLock);
+   if (nullptr != gDefaultExecutor) {
+      return false;
+   }
+   gDefaultOptions = options;
+   return true;
+}
+
+/**
+ * @return the process wide executor, created at first use. It is never destroyed, tasks
+ *         that are still queued when the process exits are not run
+ */
+IOExecutor& DefaultIOExecutor() {
+   std::lock_guard<std::mutex> lock(gDefaultLock);
+   if (nullptr == gDefaultExecutor) {
+      gDefaultExecutor = new IOExecutor(gDefaultOptions);
+   }
+   return *gDefaultExecutor;
+}
+} // namespace FileIO
@@ -0,0 +1,64 @@
+/*
+ * File:   IOExecutor.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FileIO {
+
+/// What Submit does when the queue is full
+enum class Backpressure {
+   Reject, ///< Submit returns false at once, the caller never blocks
+   Block   ///< Submit waits until there is room in the queue
+};
+
+struct ExecutorOptions {
+   size_t threads = 4;
+   size_t queueCapacity = 1024;  ///< tasks waiting for a thread
+   Backpressure whenFull = Backpressure::Reject;
+};
+
+/**
+ * Runs blocking file I/O on its own threads, for callers that must not block such as
+ * event loops. The queue is bounded: when the disk cannot keep up the queue fills and
+ * Submit rejects, or blocks, see Backpressure, instead of queueing without limit.
+ * The async functions in AsyncFileIO.h run on DefaultIOExecutor() unless they are given
+ * an executor.
+ */
+class IOExecutor {
+public:
+   typedef std::function<void()> Task;
+
+   explicit IOExecutor(const ExecutorOptions& options = ExecutorOptions{});
+   ~IOExecutor();
+
+   bool Submit(Task task);
+   size_t Queued() const;
+
+   IOExecutor(const IOExecutor&) = delete;
+   IOExecutor& operator=(const IOExecutor&) = delete;
+
+private:
+   void Run();
+
+   const ExecutorOptions mOptions;
+   mutable std::mutex mLock;
+   std::condition_variable mNotEmpty;
+   std::condition_variable mNotFull;
+   std::deque<Task> mQueue;
+   bool mStop;
+   std::vector<std::thread> mWorkers;
+};
+
+bool ConfigureDefaultIOExecutor(const ExecutorOptions& options);
+IOExecutor& DefaultIOExecutor();
+} // namespace FileIO
@@ -0,0 +1,184 @@
+/*
+ * File:   IoUring.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "IoUring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace {
+   int SetupSyscall(const unsigned entries, io_uring_params* parameters) {
+      return static_cast<int> (syscall(__NR_io_uring_setup, entries, parameters));
+   }
+
+   int EnterSyscall(const int fd, const unsigned toSubmit, const unsigned minComplete, const unsigned flags) {
+      return static_cast<int> (syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+   }
+
+   int RegisterSyscall(const int fd, const unsigned opcode, void* argument, const unsigned count) {
+      return static_cast<int> (syscall(__NR_io_uring_register, fd, opcode, argument, count));
+   }
+
+   void* MapRing(const int fd, const size_t size, const off_t offset) {
+      void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+      return (MAP_FAILED == ring) ? nullptr : ring;
+   }
+
+   template<typename T> T* At(void* ring, const unsigned offset) {
+      return reinterpret_cast<T*> (static_cast<char*> (ring) + offset);
+   }
+} // anonymous helper
+
+
+namespace FileIO {
+
+/**
+ * @param entries size of the submission queue, rounded up to a power of two by the kernel.
+ *        The completion queue is twice as large
+ * @param requiredOpcodes IORING_OP_ values that must be supported, checked with IORING_REGISTER_PROBE
+ */
+IoUring::IoUring(const unsigned entries, std::initializer_list<uint8_t> requiredOpcodes)
+: mFd(-1)
+, mSqRing(nullptr)
+, mSqRingSize(0)
+, mCqRing(nullptr)
+, mCqRingSize(0)
+, mSqes(nullptr)
+, mSqesSize(0)
+, mSqEntries(0)
+, mSqHead(nullptr)
+, mSqTail(nullptr)
+, mSqMask(nullptr)
+, mSqArray(nullptr)
+, mCqHead(nullptr)
+, mCqTail(nullptr)
+, mCqMask(nullptr)
+, mCqes(nullptr)
+, mToSubmit(0)
+, mValid{Setup(entries, requiredOpcodes)} {
+}
+
+IoUring::~IoUring() {
+   if (nullptr != mSqes) {
+      munmap(mSqes, mSqesSize);
+   }
+   if (nullptr != mCqRing && mCqRing != mSqRing) {
+      munmap(mCqRing, mCqRingSize);
+   }
+   if (nullptr != mSqRing) {
+      munmap(mSqRing, mSqRingSize);
+   }
+   if (-1 != mFd) {
+      close(mFd);
+   }
+}
+
+Result<bool> IoUring::Setup(const unsigned entries, std::initializer_list<uint8_t> requiredOpcodes) {
+   io_uring_params parameters;
+   memset(&parameters, 0, sizeof (parameters));
+   mFd = SetupSyscall(entries, &parameters);
+   if (-1 == mFd) {
+      return Result<bool>{false, {"io_uring is not available, error: " + std::string{std::strerror(errno)}}};
+   }
+
+   mSqRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof (unsigned);
+   mCqRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof (io_uring_cqe);
+   if (parameters.features & IORING_FEAT_SINGLE_MMAP) {
+      mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+   }
+   mSqRing = MapRing(mFd, mSqRingSize, IORING_OFF_SQ_RING);
+   if (nullptr == mSqRing) {
+      return Result<bool>{false, {"Cannot map the io_uring submission queue, error: " + std::string{std::strerror(errno)}}};
+   }
+   mCqRing = (parameters.features & IORING_FEAT_SINGLE_MMAP) ? mSqRing : MapRing(mFd, mCqRingSize, IORING_OFF_CQ_RING);
+   if (nullptr == mCqRing) {
+      return Result<bool>{false, {"Cannot map the io_uring completion queue, error: " + std::string{std::strerror(errno)}}};
+   }
+   mSqesSize = parameters.sq_entries * sizeof (io_uring_sqe);
+   mSqes = static_cast<io_uring_sqe*> (MapRing(mFd, mSqesSize, IORING_OFF_SQES));
+   if (nullptr == mSqes) {
+      return Result<bool>{false, {"Cannot map the io_uring submission entries, error: " + std::string{std::strerror(errno)}}};
+   }
+
+   mSqEntries = parameters.sq_entries;
+   mSqHead = At<unsigned>(mSqRing, parameters.sq_off.head);
+   mSqTail = At<unsigned>(mSqRing, parameters.sq_off.tail);
+   mSqMask = At<unsigned>(mSqRing, parameters.sq_off.ring_mask);
+   mSqArray = At<unsigned>(mSqRing, parameters.sq_off.array);
+   mCqHead = At<unsigned>(mCqRing, parameters.cq_off.head);
+   mCqTail = At<unsigned>(mCqRing, parameters.cq_off.tail);
+   mCqMask = At<unsigned>(mCqRing, parameters.cq_off.ring_mask);
+   mCqes = At<io_uring_cqe>(mCqRing, parameters.cq_off.cqes);
+
+   const size_t probeSize = sizeof (io_uring_probe) + 256 * sizeof (io_uring_probe_op);
+   std::vector<uint64_t> probeMemory((probeSize + sizeof (uint64_t) - 1) / sizeof (uint64_t), 0);
+   io_uring_probe* probe = reinterpret_cast<io_uring_probe*> (probeMemory.data());
+   if (0 != RegisterSyscall(mFd, IORING_REGISTER_PROBE, probe, 256)) {
+      return Result<bool>{false, {"Cannot probe io_uring, error: " + std::string{std::strerror(errno)}}};
+   }
+   for (const uint8_t opcode : requiredOpcodes) {
+      if (opcode > probe->last_op || 0 == (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+         return Result<bool>{false, {"io_uring does not support opcode " + std::to_string(opcode)}};
+      }
+   }
+   return Result<bool>{true};
+}
+
+/**
+ * @return a cleared submission entry, nullptr if the submission queue is full.
+ *         The entry is handed to the kernel with the next Submit()
+ */
+io_uring_sqe* IoUring::GetSqe() {
+   const unsigned tail = *mSqTail;
+   if (tail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) >= mSqEntries) {
+      return nullptr;
+   }
+   const unsigned index = tail & *mSqMask;
+   io_uring_sqe* sqe = &mSqes[index];
+   memset(sqe, 0, sizeof (*sqe));
+   mSqArray[index] = index;
+   __atomic_store_n(mSqTail, tail + 1, __ATOMIC_RELEASE);
+   ++mToSubmit;
+   return sqe;
+}
+
+/**
+ * Submits the filled entries in one system call and waits for completions
+ * @param waitFor number of completions to wait for, zero to only submit
+ * @return 0, or the errno of io_uring_enter. EINTR is retried
+ */
+int IoUring::Submit(const unsigned waitFor) {
+   while (true) {
+      const int submitted = EnterSyscall(mFd, mToSubmit, waitFor, (waitFor > 0) ? IORING_ENTER_GETEVENTS : 0);
+      if (submitted >= 0) {
+         mToSubmit -= std::min(mToSubmit, static_cast<unsigned> (submitted));
+         return 0;
+      }
+      if (EINTR != errno) {
+         return errno;
+      }
+   }
+}
+
+/**
+ * Waits for completions without submitting anything
+ * @param waitFor number of completions to wait for
+ * @return 0, or the errno of io_uring_enter. EINTR is retried
+ */
+int IoUring::Wait(const unsigned waitFor) {
+   while (-1 == EnterSyscall(mFd, 0, waitFor, IORING_ENTER_GETEVENTS)) {
+      if (EINTR != errno) {
+         return errno;
+      }
+   }
+   return 0;
+}
+} // namespace FileIO
@@ -0,0 +1,96 @@
+/*
+ * File:   IoUring.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include "Result.h"
+
+namespace FileIO {
+
+/**
+ * Minimal io_uring, straight on the system calls so that there is no dependency on liburing.
+ * One thread at a time: the submission queue is filled with GetSqe(), Submit() hands the
+ * filled entries to the kernel and waits for completions, Reap() consumes the completions.
+ *
+ * Valid() fails when the kernel does not have io_uring, when it is disabled
+ * (kernel.io_uring_disabled, seccomp in containers) or when one of the required opcodes
+ * is not supported. Callers are expected to fall back to plain system calls.
+ */
+class IoUring {
+public:
+   IoUring(const unsigned entries, std::initializer_list<uint8_t> requiredOpcodes);
+   ~IoUring();
+
+   Result<bool> Valid() const {
+      return mValid;
+   }
+   unsigned Entries() const {
+      return mSqEntries;
+   }
+
+   io_uring_sqe* GetSqe();
+   int Submit(const unsigned waitFor);
+   int Wait(const unsigned waitFor);
+
+   /**
+    * Takes back the entries that the kernel did not consume, e.g. after a failed Submit().
+    * Calls handler(const io_uring_sqe&) for each of them, @return the number of entries
+    */
+   template<typename Handler>
+   size_t DiscardUnsubmitted(Handler handler) {
+      const unsigned head = __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE);
+      const unsigned tail = *mSqTail;
+      for (unsigned entry = head; entry != tail; ++entry) {
+         handler(mSqes[mSqArray[entry & *mSqMask]]);
+      }
+      __atomic_store_n(mSqTail, head, __ATOMIC_RELEASE);
+      mToSubmit = 0;
+      return tail - head;
+   }
+
+   /// Calls handler(const io_uring_cqe&) for every completion, @return the number of completions
+   template<typename Handler>
+   size_t Reap(Handler handler) {
+      unsigned head = *mCqHead;
+      const unsigned tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+      size_t reaped = 0;
+      for (; head != tail; ++head, ++reaped) {
+         handler(mCqes[head & *mCqMask]);
+      }
+      __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+      return reaped;
+   }
+
+   IoUring(const IoUring&) = delete;
+   IoUring& operator=(const IoUring&) = delete;
+
+private:
+   Result<bool> Setup(const unsigned entries, std::initializer_list<uint8_t> requiredOpcodes);
+
+   int mFd;
+   void* mSqRing;
+   size_t mSqRingSize;
+   void* mCqRing;
+   size_t mCqRingSize;
+   io_uring_sqe* mSqes;
+   size_t mSqesSize;
+   unsigned mSqEntries;
+   unsigned* mSqHead;
+   unsigned* mSqTail;
+   unsigned* mSqMask;
+   unsigned* mSqArray;
+   unsigned* mCqHead;
+   unsigned* mCqTail;
+   unsigned* mCqMask;
+   io_uring_cqe* mCqes;
+   unsigned mToSubmit;   ///< entries filled since the last Submit
+   Result<bool> mValid;
+};
+} // namespace FileIO
@@ -0,0 +1,124 @@
+/*
+ * File:   MappedFile.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "MappedFile.h"
+#include "FileIO.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+
+namespace FileIO {
+
+MappedFile::MappedFile()
+   : mContent{}
+   , mSize{0}
+   , mIsMapped{false} {}
+
+MappedFile::MappedFile(std::shared_ptr<const uint8_t> content, const size_t size, const bool isMapped)
+   : mContent{content}
+   , mSize{size}
+   , mIsMapped{isMapped} {}
+
+const uint8_t* MappedFile::Data() const {
+   return mContent.get();
+}
+
+size_t MappedFile::Size() const {
+   return mSize;
+}
+
+bool MappedFile::Empty() const {
+   return (0 == mSize);
+}
+
+bool MappedFile::IsMapped() const {
+   return mIsMapped;
+}
+
+const uint8_t* MappedFile::begin() const {
+   return Data();
+}
+
+const uint8_t* MappedFile::end() const {
+   return Data() + mSize;
+}
+
+/**
+ * Give the kernel a hint of how the mapped content will be accessed
+ * @param advice, any of the MappedFile::Advice madvise hints
+ * @return Result<bool> whether or not the kernel accepted the hint. A buffered
+ *         (non mapped) file ignores the hint and is always successful
+ */
+Result<bool> MappedFile::Advise(const Advice advice) const {
+   if (!mIsMapped || Empty()) {
+      return Result<bool>{true};
+   }
+
+   void* address = const_cast<uint8_t*>(mContent.get());
+   if (0 != madvise(address, mSize, static_cast<int>(advice))) {
+      return Result<bool>{false, {"madvise failed: " + std::string{std::strerror(errno)}}};
+   }
+   return Result<bool>{true};
+}
+
+/**
+ * Memory maps the content of a file for read-only access. Files that cannot be
+ * mapped, i.e. anything that is not a regular file or a file that reports zero size
+ * such as procfs entries, are read with ReadBinaryFileContent instead.
+ *
+ * @param pathToFile to map
+ * @param advice madvise hint for the mapping, default is sequential access
+ * @return Result<MappedFile> with a view of the file content, and/or an error string
+ *         if something went wrong
+ */
+Result<MappedFile> ReadMappedFileContent(const std::string& pathToFile, const MappedFile::Advice advice) {
+   auto ReadBuffered = [](const std::string& path) -> Result<MappedFile> {
+      // read straight into the buffer that the view keeps alive, Result::result is const and
+      // cannot be moved from
+      auto buffer = std::make_shared<std::vector<uint8_t>>();
+      auto buffered = ReadBinaryFileContentInto(path, *buffer);
+      if (buffered.HasFailed()) {
+         return Result<MappedFile>{{}, buffered.error};
+      }
+      std::shared_ptr<const std::vector<uint8_t>> owner = buffer;
+      std::shared_ptr<const uint8_t> content(owner, owner->data());
+      return Result<MappedFile>{MappedFile{content, owner->size(), false}};
+   };
+
+   ScopedFileDescriptor file(pathToFile, O_RDONLY | O_CLOEXEC, 0);
+   if (-1 == file.fd) {
+      return Result<MappedFile>{{}, {"Cannot read-open file: " + pathToFile}};
+   }
+
+   struct stat fileInfo;
+   if (0 != fstat(file.fd, &fileInfo)) {
+      return Result<MappedFile>{{}, {"Cannot stat file: " + pathToFile + ", error: " + std::strerror(errno)}};
+   }
+
+   // procfs, sysfs, pipes and devices cannot be mapped. They are read the same way
+   // as the tellg() fallback in ReadBinaryFileContent
+   const size_t size = static_cast<size_t>(fileInfo.st_size);
+   if (!S_ISREG(fileInfo.st_mode) || 0 == size) {
+      return ReadBuffered(pathToFile);
+   }
+
+   void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+   if (MAP_FAILED == address) {
+      return ReadBuffered(pathToFile);
+   }
+
+   // RAII: the mapping is released when the last MappedFile copy is destroyed
+   std::shared_ptr<const uint8_t> content(static_cast<const uint8_t*>(address), [size](const uint8_t* mapped) {
+      munmap(const_cast<uint8_t*>(mapped), size);
+   });
+
+   MappedFile mapped{content, size, true};
+   mapped.Advise(advice); // a hint only, failure is not an error
+   return Result<MappedFile>{mapped};
+}
+} // namespace FileIO
@@ -0,0 +1,54 @@
+/*
+ * File:   MappedFile.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <sys/mman.h>
+#include "Result.h"
+
+namespace FileIO {
+
+/**
+ * Read-only view of a file's content. Regular files are memory mapped so that
+ * reading them costs neither heap allocations nor memcpy. Files that cannot
+ * be mapped (procfs entries, pipes, devices) are read into a buffer instead.
+ *
+ * The view is cheap to copy, the mapping is released (munmap) when the last
+ * copy goes out of scope.
+ */
+class MappedFile {
+public:
+   /// madvise hints. Ref: http://man7.org/linux/man-pages/man2/madvise.2.html
+   enum class Advice : int {Normal = MADV_NORMAL, Sequential = MADV_SEQUENTIAL, Random = MADV_RANDOM, WillNeed = MADV_WILLNEED};
+
+   MappedFile();
+
+   const uint8_t* Data() const;
+   size_t Size() const;
+   bool Empty() const;
+
+   /// @return false if the content was read into a buffer instead of being mapped
+   bool IsMapped() const;
+   Result<bool> Advise(const Advice advice) const;
+
+   const uint8_t* begin() const;
+   const uint8_t* end() const;
+
+private:
+   friend Result<MappedFile> ReadMappedFileContent(const std::string& pathToFile, const MappedFile::Advice advice);
+   MappedFile(std::shared_ptr<const uint8_t> content, const size_t size, const bool isMapped);
+
+   std::shared_ptr<const uint8_t> mContent;
+   size_t mSize;
+   bool mIsMapped;
+};
+
+Result<MappedFile> ReadMappedFileContent(const std::string& pathToFile, const MappedFile::Advice advice = MappedFile::Advice::Sequential);
+} // namespace FileIO
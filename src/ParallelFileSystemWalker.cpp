@@ -0,0 +1,231 @@
+/*
+ * File:   ParallelFileSystemWalker.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "ParallelFileSystemWalker.h"
+#include "WorkStealingPool.h"
+#include "FileSystemWalker.h"
+#include "FileIO.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+   /// fts_number of a directory that was split off, fts returns skipped directories once more as FTS_DP.
+   /// Not to be confused with FileSystemWalker::kSkipSubtree
+   const long kSplitOff = 1;
+
+   /// State shared by all the subtree walks of one ParallelFileSystemWalker::Action
+   struct ParallelWalk {
+      ParallelWalk(ParallelFileSystemWalker::HandlerFactory& factory, const size_t threads, const dev_t device)
+         : handlerFactory(factory)
+         , pool(threads)
+         , rootDevice(device)
+         , queuedWalks(0)
+         , stop(false)
+         , status(0)
+         , failedError(0) {}
+
+      ParallelFileSystemWalker::HandlerFactory& handlerFactory;
+      FileIO::WorkStealingPool pool;
+      const dev_t rootDevice;
+      std::atomic<size_t> queuedWalks; ///< subtrees waiting for a thread
+      std::atomic<bool> stop;          ///< a handler returned non-zero
+      std::atomic<int> status;         ///< the first non-zero handler return, -1 if a subtree could not be walked
+      std::mutex failureLock;
+      std::string failedPath;          ///< the first subtree that could not be walked
+      int failedError;
+      std::mutex handlersLock;
+      std::map<std::thread::id, ParallelFileSystemWalker::FtsHandler> handlers;
+
+      /// @return the handler of the calling thread, created by the factory at first use
+      ParallelFileSystemWalker::FtsHandler& Handler() {
+         std::lock_guard<std::mutex> lock(handlersLock);
+         auto found = handlers.find(std::this_thread::get_id());
+         if (handlers.end() == found) {
+            found = handlers.emplace(std::this_thread::get_id(), handlerFactory()).first;
+         }
+         return found->second;
+      }
+
+      /// Records the first non-zero handler status and stops all the walks
+      void Stop(const int handlerStatus) {
+         int expected = 0;
+         status.compare_exchange_strong(expected, handlerStatus);
+         stop = true;
+      }
+
+      /// Records the first subtree that could not be walked and stops all the walks with status -1
+      void Fail(const std::string& path, const int error) {
+         {
+            std::lock_guard<std::mutex> lock(failureLock);
+            if (failedPath.empty()) {
+               failedPath = path;
+               failedError = error;
+            }
+         }
+         Stop(-1);
+      }
+
+      /**
+       * A subdirectory is given to another thread while there are fewer subtrees waiting
+       * than there are threads. Directories on other devices are never split off, the
+       * subtree walk would otherwise cross the FTS_XDEV boundary of the start path
+       */
+      bool ShouldSplit(const FTSENT* node) const {
+         return (node->fts_level > FTS_ROOTLEVEL && queuedWalks < pool.Threads()
+                 && nullptr != node->fts_statp && node->fts_statp->st_dev == rootDevice);
+      }
+   };
+
+   struct ScopedFts {
+      FTS* mFts;
+
+      explicit ScopedFts(FTS* fts) : mFts(fts) { }
+
+      ~ScopedFts() {
+         if (nullptr != mFts) {
+            fts_close(mFts);
+         }
+      }
+
+      ScopedFts() = delete;
+      ScopedFts(const ScopedFts&) = delete;
+      ScopedFts& operator=(const ScopedFts&) = delete;
+   };
+
+   /**
+    * Walks one subtree with fts and calls the thread's handler for every entry. Subdirectories
+    * are split off to the pool, see ParallelWalk::ShouldSplit. A split off directory is skipped
+    * here and delivered, both FTS_D and FTS_DP, by the walk of its own subtree.
+    *
+    * @param path root of the subtree
+    * @param baseLevel depth of the subtree's root below the start path, fts_level is
+    *        adjusted with it so that the handler sees the depth from the start path
+    * @param isStartPath the walk of the start path waits for all other walks before it
+    *        delivers the FTS_DP of the start path
+    */
+   void WalkSubtree(ParallelWalk& walk, const std::string& path, const short baseLevel, const bool isStartPath) {
+      if (walk.stop) {
+         return;
+      }
+
+      char* rawpath = const_cast<char*> (path.c_str());
+      char* ftsRawPath[] = {rawpath, nullptr};
+      // Same flags as FileSystemWalker. FTS_NOCHDIR is a must, the threads share the working directory
+      ScopedFts fileSystem(fts_open(ftsRawPath, FTS_PHYSICAL | FTS_XDEV | FTS_NOCHDIR, nullptr));
+      if (nullptr == fileSystem.mFts) {
+         walk.Fail(path, errno); // the subtree would be missing from the walk
+         return;
+      }
+
+      auto& handler = walk.Handler();
+      FTSENT* node = nullptr;
+      errno = 0;
+      while (!walk.stop && (node = fts_read(fileSystem.mFts)) != nullptr) {
+         const int info = node->fts_info;
+         if (FTS_DP == info && kSplitOff == node->fts_number) {
+            continue; // delivered by its own walk
+         }
+         if (FTS_D == info && walk.ShouldSplit(node)) {
+            node->fts_number = kSplitOff;
+            fts_set(fileSystem.mFts, node, FTS_SKIP);
+            const std::string subtree{node->fts_path};
+            const short level = baseLevel + node->fts_level;
+            ++walk.queuedWalks;
+            walk.pool.Submit([&walk, subtree, level] {
+               --walk.queuedWalks;
+               WalkSubtree(walk, subtree, level, false);
+            });
+            continue;
+         }
+
+         if (isStartPath && FTS_DP == info && FTS_ROOTLEVEL == node->fts_level) {
+            walk.pool.Wait();
+            if (walk.stop) {
+               break;
+            }
+         }
+
+         const short level = node->fts_level;
+         node->fts_level = baseLevel + level;
+         const int status = handler(node, info);
+         node->fts_level = level;
+         if (0 != status) {
+            walk.Stop(status);
+         }
+         if (FTS_D == info && FileSystemWalker::kSkipSubtree == node->fts_number) {
+            fts_set(fileSystem.mFts, node, FTS_SKIP);
+         }
+         errno = 0;
+      }
+      if (nullptr == node && 0 != errno) {
+         walk.Fail(path, errno); // fts_read gave up before the end of the subtree
+      }
+   }
+} // anonymous helper
+
+/**
+ * @param startPath to traverse the directory at
+ * @param handlerFactory called once per thread to create the FTSENT handler of that thread
+ * @param threads number of threads, the calling thread of Action() comes in addition
+ */
+ParallelFileSystemWalker::ParallelFileSystemWalker(const std::string& startPath, HandlerFactory handlerFactory, const size_t threads)
+: mHandlerFactory(handlerFactory)
+, mStartPath(startPath)
+, mThreads(threads) {
+}
+
+/**
+ * @return true if the directory exist
+ */
+bool ParallelFileSystemWalker::IsValid() const {
+   return FileIO::DoesDirectoryExist(mStartPath);
+}
+
+/**
+ * Walks through the whole directory tree, starting at the given path, see FileSystemWalker::Action.
+ * Every file and directory is handed to exactly one of the handlers, the walk of the start path
+ * is done by the calling thread and the subtrees that it, or any other thread, finds while
+ * there are idle threads are walked by the pool. The same fts flags as FileSystemWalker are used:
+ * symbolic links are not followed and the walk stays on the device of the start path.
+ *
+ * Ordering: within a subtree the entries come in fts order. Across threads there is no order,
+ * with one exception: the FTS_DP of the start path is always the last entry. A directory
+ * that was split off gets both its FTS_D and its FTS_DP from its own walk, so the FTS_DP of
+ * its parent directory may come before it.
+ *
+ * When a handler returns a non-zero value all threads stop at their next entry. The first
+ * non-zero value is returned. A subtree that cannot be walked at all, e.g. fts_open fails
+ * with EMFILE or ENOMEM, stops the walk with -1 and an error naming the subtree.
+ *
+ * @result Result<int> with traversal status and any possible error messages
+ */
+Result<int> ParallelFileSystemWalker::Action() {
+   struct stat startInfo;
+   if (!IsValid() || 0 != lstat(mStartPath.c_str(), &startInfo)) {
+      return Result<int>{-1, {"Invalid Path: " + mStartPath}};
+   }
+
+   std::unique_ptr<ParallelWalk> walk{new ParallelWalk(mHandlerFactory, mThreads, startInfo.st_dev)};
+   WalkSubtree(*walk, mStartPath, 0, true);
+   walk->pool.Wait();
+
+   const int status = walk->status;
+   if (-1 == status && !walk->failedPath.empty()) {
+      return Result<int>{status, {"Cannot walk: " + walk->failedPath + " below: " + mStartPath + ", error: " + std::strerror(walk->failedError)}};
+   }
+   if (-1 == status) {
+      return Result<int>{status, {"Error occurred during file access starting from: " + mStartPath + ", error: " + std::strerror(errno)}};
+   }
+   return Result<int>{status};
+}
@@ -0,0 +1,36 @@
+/*
+ * File:   ParallelFileSystemWalker.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <functional>
+#include <fts.h>
+#include "Result.h"
+
+/*
+ * ParallelFileSystemWalker walks a directory tree like FileSystemWalker but spreads the
+ * subtrees over a pool of threads. Every thread gets its own handler from the handler
+ * factory, so a handler does not have to be thread-safe.
+ * A handler can prune a subtree with FileSystemWalker::SkipSubtree.
+ */
+class ParallelFileSystemWalker {
+public:
+   typedef std::function<int(FTSENT*, int ftstype_flag)> FtsHandler;
+   typedef std::function<FtsHandler()> HandlerFactory;
+
+   ParallelFileSystemWalker(const std::string& startPath, HandlerFactory handlerFactory, const size_t threads);
+   bool IsValid() const;
+   Result<int> Action();
+
+   ParallelFileSystemWalker() = delete;
+   ParallelFileSystemWalker(const ParallelFileSystemWalker&) = delete;
+   ParallelFileSystemWalker& operator=(const ParallelFileSystemWalker&) = delete;
+private:
+   HandlerFactory mHandlerFactory;
+   const std::string mStartPath;
+   const size_t mThreads;
+};
@@ -7,6 +7,7 @@
  */
 #pragma once
 #include <string>
+#include <utility>
 
 
 /**
@@ -25,10 +26,10 @@ template<typename T> struct Result {
     * @param err error message to the client, default is empty which means successful operation
     */
    Result(T output, const std::string& err)
-   : result{output}, error{err} {
+   : result{std::move(output)}, error{err} {
    }
 
-   Result(T output) : result{output}, error{""}{
+   Result(T output) : result{std::move(output)}, error{""}{
    }
 
    Result() = delete;
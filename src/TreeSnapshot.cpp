@@ -0,0 +1,433 @@
+/*
+ * File:   TreeSnapshot.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "TreeSnapshot.h"
+#include "FileIO.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace {
+   const uint64_t kFnvOffset = 14695981039346656037ULL;
+   const uint64_t kFnvPrime = 1099511628211ULL;
+   /// the root's path relative to itself is empty, its hash is the FNV offset basis
+   const uint64_t kRootHash = kFnvOffset;
+
+   /// Covers file systems with one second timestamps, e.g. ext3
+   const int64_t kRacyNs = 2000000000LL;
+
+   const char kMagic[8] = {'F', 'I', 'O', 'S', 'N', 'A', 'P', '1'};
+
+   uint64_t HashAppend(uint64_t hash, const char* data, const size_t length) {
+      for (size_t index = 0; index < length; ++index) {
+         hash ^= static_cast<unsigned char> (data[index]);
+         hash *= kFnvPrime;
+      }
+      return hash;
+   }
+
+   /// @return the hash of the path "parent/name", children of the root have no leading '/'
+   uint64_t ChildHash(const uint64_t parentHash, const std::string& name) {
+      const uint64_t hash = (kRootHash == parentHash) ? parentHash : HashAppend(parentHash, "/", 1);
+      return HashAppend(hash, name.data(), name.size());
+   }
+
+   int64_t ModifiedNs(const struct stat& info) {
+      return int64_t{info.st_mtim.tv_sec} * 1000000000 + info.st_mtim.tv_nsec;
+   }
+
+   int64_t NowNs() {
+      struct timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+      return int64_t{now.tv_sec} * 1000000000 + now.tv_nsec;
+   }
+
+   FileIO::EntryType TypeOf(const struct stat& info) {
+      return static_cast<FileIO::EntryType> (IFTODT(info.st_mode));
+   }
+
+   bool ByInode(const FileIO::DirectoryEntry& left, const FileIO::DirectoryEntry& right) {
+      return left.inode < right.inode;
+   }
+
+   template<typename T> void Put(std::string& buffer, const T& value) {
+      buffer.append(reinterpret_cast<const char*> (&value), sizeof (value));
+   }
+
+   template<typename T> bool Get(const std::vector<uint8_t>& buffer, size_t& offset, T& value) {
+      if (buffer.size() - offset < sizeof (value)) {
+         return false;
+      }
+      memcpy(&value, buffer.data() + offset, sizeof (value));
+      offset += sizeof (value);
+      return true;
+   }
+
+   bool GetString(const std::vector<uint8_t>& buffer, size_t& offset, const size_t length, std::string& value) {
+      if (buffer.size() - offset < length) {
+         return false;
+      }
+      value.assign(reinterpret_cast<const char*> (buffer.data() + offset), length);
+      offset += length;
+      return true;
+   }
+
+   /// @return true if the saved type byte is one of the EntryType values
+   bool IsEntryType(const uint8_t type) {
+      switch (static_cast<FileIO::EntryType> (type)) {
+         case FileIO::EntryType::Unknown:
+         case FileIO::EntryType::Fifo:
+         case FileIO::EntryType::CharacterDevice:
+         case FileIO::EntryType::Directory:
+         case FileIO::EntryType::BlockDevice:
+         case FileIO::EntryType::File:
+         case FileIO::EntryType::SymbolicLink:
+         case FileIO::EntryType::Socket:
+         case FileIO::EntryType::Whiteout:
+            return true;
+      }
+      return false;
+   }
+} // anonymous helper
+
+
+namespace FileIO {
+
+TreeSnapshot::TreeSnapshot()
+: mTakenNs(0) {
+}
+
+/**
+ * Takes a new snapshot of the tree, any previous snapshot is dropped
+ * @param root directory of the tree
+ * @return Result<bool> with an error if the root could not be read
+ */
+Result<bool> TreeSnapshot::Take(const std::string& root) {
+   mRecords.clear();
+   mRoot = root;
+   while (mRoot.size() > 1 && '/' == mRoot.back()) {
+      mRoot.pop_back();
+   }
+   Scan scan{nullptr, SnapshotOptions{}, 0, 0};
+   return ScanTree(scan);
+}
+
+/**
+ * Compares the tree with the snapshot and updates the snapshot. A directory is reported
+ * before what is in it when it is added or removed. Directories are never reported as
+ * modified, their changes show as added and removed entries.
+ * A file is modified when its inode, size or modification time changed, a file that was
+ * replaced by a rename is modified. An entry that changed type is removed and added
+ *
+ * @param options see SnapshotOptions
+ * @return Result<std::vector<TreeChange>> the changes since the last Take or Update
+ */
+Result<std::vector<TreeChange>> TreeSnapshot::Update(const SnapshotOptions& options) {
+   if (mRecords.empty()) {
+      return Result<std::vector<TreeChange>>{{}, {"No snapshot was taken or loaded"}};
+   }
+   std::vector<TreeChange> changes;
+   Scan scan{&changes, options, 0, mTakenNs - kRacyNs};
+   auto scanned = ScanTree(scan);
+   if (scanned.HasFailed()) {
+      return Result<std::vector<TreeChange>>{{}, scanned.error};
+   }
+   return Result<std::vector<TreeChange>>{changes};
+}
+
+Result<bool> TreeSnapshot::ScanTree(Scan& scan) {
+   const int64_t startNs = NowNs();
+   struct stat info;
+   if (0 != lstat(mRoot.c_str(), &info) || !S_ISDIR(info.st_mode)) {
+      return Result<bool>{false, {"Invalid Path: " + mRoot}};
+   }
+   scan.device = info.st_dev;
+
+   bool listingChanged = true;
+   auto found = mRecords.find(kRootHash);
+   if (mRecords.end() == found) {
+      mRecords.emplace(kRootHash, Record{0, info.st_ino, static_cast<uint64_t> (info.st_size), ModifiedNs(info), EntryType::Directory, {}, {}});
+   } else {
+      Record& record = found->second;
+      listingChanged = (record.inode != info.st_ino || record.modifiedNs != ModifiedNs(info) || record.modifiedNs >= scan.racyFromNs);
+      record.inode = info.st_ino;
+      record.size = info.st_size;
+      record.modifiedNs = ModifiedNs(info);
+   }
+
+   std::string path = mRoot;
+   VisitDirectory(path, kRootHash, listingChanged, scan);
+   mTakenNs = startNs;
+   return Result<bool>{true};
+}
+
+/**
+ * @param path of the directory, children are appended to it and removed again
+ * @param listingChanged false if the directory's inode and modification time are the same
+ *        as in the snapshot, the directory is then not read
+ */
+void TreeSnapshot::VisitDirectory(std::string& path, const uint64_t hash, const bool listingChanged, Scan& scan) {
+   ScopedFileDescriptor directoryFd(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC, 0);
+   if (-1 == directoryFd.fd) {
+      return; // unreadable: it keeps the entries it had
+   }
+   if (!listingChanged && StatKnownChildren(path, directoryFd.fd, hash, scan)) {
+      return;
+   }
+   ListChildren(path, directoryFd.fd, hash, scan);
+}
+
+/**
+ * Stats the entries the snapshot has for a directory that did not change
+ * @return false if an entry is missing after all, the directory must then be read
+ */
+bool TreeSnapshot::StatKnownChildren(std::string& path, const int directoryFd, const uint64_t hash, Scan& scan) {
+   const std::vector<uint64_t> known = mRecords.at(hash).children;
+   std::vector<struct stat> infos(known.size());
+   std::vector<bool> skipped(known.size(), false);
+   for (size_t index = 0; index < known.size(); ++index) {
+      const Record& child = mRecords.at(known[index]);
+      if (EntryType::Directory != child.type && !scan.options.statFiles) {
+         skipped[index] = true;
+      } else if (0 != fstatat(directoryFd, child.name.c_str(), &infos[index], AT_SYMLINK_NOFOLLOW)) {
+         return false;
+      }
+   }
+
+   std::vector<uint64_t> children;
+   children.reserve(known.size());
+   for (size_t index = 0; index < known.size(); ++index) {
+      if (skipped[index]) {
+         children.push_back(known[index]);
+      } else {
+         const std::string name = mRecords.at(known[index]).name;
+         UpdateChild(path, hash, name, infos[index], scan, children);
+      }
+   }
+   mRecords.at(hash).children = std::move(children);
+   return true;
+}
+
+/// Reads a directory, the entries are stat'ed in inode order, see ListDirectory
+void TreeSnapshot::ListChildren(std::string& path, const int directoryFd, const uint64_t hash, Scan& scan) {
+   DirectoryReader reader(path, DirectoryReader::kDefaultBufferSize, true);
+   if (reader.Valid().HasFailed()) {
+      return;
+   }
+   std::vector<DirectoryEntry> entries;
+   DirectoryEntry entry;
+   while (reader.Next(entry)) {
+      entries.push_back(entry);
+   }
+   if (0 != reader.ReadError()) {
+      return; // partly read: it keeps the entries it had
+   }
+   std::sort(entries.begin(), entries.end(), ByInode);
+
+   std::vector<uint64_t> children;
+   children.reserve(entries.size());
+   for (const auto& listed : entries) {
+      struct stat info;
+      if (0 == fstatat(directoryFd, listed.name.c_str(), &info, AT_SYMLINK_NOFOLLOW)) {
+         UpdateChild(path, hash, listed.name, info, scan, children);
+      } // removed since it was listed
+   }
+
+   Record& directory = mRecords.at(hash);
+   std::vector<uint64_t> sorted = children;
+   std::sort(sorted.begin(), sorted.end());
+   const std::vector<uint64_t> previous = directory.children;
+   directory.children = std::move(children);
+   for (const uint64_t child : previous) {
+      if (!std::binary_search(sorted.begin(), sorted.end(), child)) {
+         RemoveSubtree(child, scan);
+      }
+   }
+}
+
+/**
+ * Compares an entry with the snapshot, reports and records the difference and visits it
+ * if it is a directory on the same device
+ * @param children the hash of the entry is added to it
+ */
+void TreeSnapshot::UpdateChild(std::string& path, const uint64_t parentHash, const std::string& name,
+                               const struct stat& info, Scan& scan, std::vector<uint64_t>& children) {
+   const uint64_t hash = ChildHash(parentHash, name);
+   const EntryType type = TypeOf(info);
+   auto found = mRecords.find(hash);
+   if (mRecords.end() != found && found->second.type != type) {
+      RemoveSubtree(hash, scan);
+      found = mRecords.end();
+   }
+
+   bool listingChanged = true;
+   if (mRecords.end() == found) {
+      mRecords.emplace(hash, Record{parentHash, info.st_ino, static_cast<uint64_t> (info.st_size), ModifiedNs(info), type, name, {}});
+      Report(ChangeType::Added, hash, scan);
+   } else {
+      Record& record = found->second;
+      const bool same = (record.inode == info.st_ino && record.size == static_cast<uint64_t> (info.st_size)
+                         && record.modifiedNs == ModifiedNs(info));
+      listingChanged = (!same || record.modifiedNs >= scan.racyFromNs);
+      if (!same) {
+         record.inode = info.st_ino;
+         record.size = info.st_size;
+         record.modifiedNs = ModifiedNs(info);
+         if (EntryType::Directory != type) {
+            Report(ChangeType::Modified, hash, scan);
+         }
+      }
+   }
+   children.push_back(hash);
+
+   if (EntryType::Directory == type && info.st_dev == scan.device) {
+      const size_t length = path.size();
+      path.append("/").append(name);
+      VisitDirectory(path, hash, listingChanged, scan);
+      path.resize(length);
+   }
+}
+
+/// Reports and drops an entry and, for a directory, everything in it
+void TreeSnapshot::RemoveSubtree(const uint64_t hash, Scan& scan) {
+   Report(ChangeType::Removed, hash, scan);
+   const std::vector<uint64_t> children = mRecords.at(hash).children;
+   for (const uint64_t child : children) {
+      RemoveSubtree(child, scan);
+   }
+   mRecords.erase(hash);
+}
+
+void TreeSnapshot::Report(const ChangeType change, const uint64_t hash, Scan& scan) const {
+   if (nullptr != scan.changes) {
+      scan.changes->push_back(TreeChange{change, mRecords.at(hash).type, PathOf(hash)});
+   }
+}
+
+/// @return the path relative to the root, built from the names of the entry and its parents
+std::string TreeSnapshot::PathOf(uint64_t hash) const {
+   std::vector<const std::string*> names;
+   while (kRootHash != hash) {
+      const Record& record = mRecords.at(hash);
+      names.push_back(&record.name);
+      hash = record.parentHash;
+   }
+   std::string path;
+   for (auto name = names.rbegin(); name != names.rend(); ++name) {
+      if (!path.empty()) {
+         path += '/';
+      }
+      path += **name;
+   }
+   return path;
+}
+
+/**
+ * Saves the snapshot, the file is replaced atomically, see WriteFileAtomically.
+ *
+ * Format, native byte order:
+ *   "FIOSNAP1", int64 start of the last scan in ns, uint32 root length, root,
+ *   uint64 number of records, then the records with parents before their children:
+ *   uint64 path hash, uint64 parent hash, uint64 inode, uint64 size, int64 modification
+ *   time in ns, uint8 type, uint16 name length, name
+ */
+Result<bool> TreeSnapshot::Save(const std::string& snapshotFile) const {
+   if (mRecords.empty()) {
+      return Result<bool>{false, {"No snapshot was taken or loaded"}};
+   }
+   std::string buffer;
+   buffer.reserve(64 + mRoot.size() + mRecords.size() * 64);
+   buffer.append(kMagic, sizeof (kMagic));
+   Put(buffer, mTakenNs);
+   Put(buffer, static_cast<uint32_t> (mRoot.size()));
+   buffer.append(mRoot);
+   Put(buffer, static_cast<uint64_t> (mRecords.size()));
+   SaveSubtree(kRootHash, buffer);
+   return WriteFileAtomically(snapshotFile, buffer, Durability::DataSync);
+}
+
+void TreeSnapshot::SaveSubtree(const uint64_t hash, std::string& buffer) const {
+   const Record& record = mRecords.at(hash);
+   Put(buffer, hash);
+   Put(buffer, record.parentHash);
+   Put(buffer, static_cast<uint64_t> (record.inode));
+   Put(buffer, record.size);
+   Put(buffer, record.modifiedNs);
+   Put(buffer, static_cast<uint8_t> (record.type));
+   Put(buffer, static_cast<uint16_t> (record.name.size()));
+   buffer.append(record.name);
+   for (const uint64_t child : record.children) {
+      SaveSubtree(child, buffer);
+   }
+}
+
+/**
+ * Loads a snapshot saved with Save, any previous snapshot is dropped
+ * @return Result<bool> with an error if the file could not be read or is not a snapshot
+ */
+Result<bool> TreeSnapshot::Load(const std::string& snapshotFile) {
+   mRecords.clear();
+   auto content = ReadBinaryFileContent(snapshotFile);
+   if (content.HasFailed()) {
+      return Result<bool>{false, content.error};
+   }
+   const std::vector<uint8_t>& buffer = content.result;
+   const std::string corrupt{"Not a valid snapshot file: " + snapshotFile};
+   if (buffer.size() < sizeof (kMagic) || 0 != memcmp(buffer.data(), kMagic, sizeof (kMagic))) {
+      return Result<bool>{false, corrupt};
+   }
+
+   size_t offset = sizeof (kMagic);
+   uint32_t rootLength = 0;
+   uint64_t count = 0;
+   if (!Get(buffer, offset, mTakenNs) || !Get(buffer, offset, rootLength)
+       || !GetString(buffer, offset, rootLength, mRoot) || !Get(buffer, offset, count)) {
+      return Result<bool>{false, corrupt};
+   }
+
+   for (uint64_t index = 0; index < count; ++index) {
+      uint64_t hash = 0;
+      uint64_t inode = 0;
+      uint8_t type = 0;
+      uint16_t nameLength = 0;
+      Record record;
+      if (!Get(buffer, offset, hash) || !Get(buffer, offset, record.parentHash) || !Get(buffer, offset, inode)
+          || !Get(buffer, offset, record.size) || !Get(buffer, offset, record.modifiedNs) || !Get(buffer, offset, type)
+          || !Get(buffer, offset, nameLength) || !GetString(buffer, offset, nameLength, record.name) || !IsEntryType(type)) {
+         mRecords.clear();
+         return Result<bool>{false, corrupt};
+      }
+      record.inode = inode;
+      record.type = static_cast<EntryType> (type);
+      const uint64_t parentHash = record.parentHash;
+      // a path that is in the file twice would be walked twice by Update
+      if (!mRecords.emplace(hash, std::move(record)).second) {
+         mRecords.clear();
+         return Result<bool>{false, corrupt};
+      }
+      if (kRootHash != hash) {
+         auto parent = mRecords.find(parentHash);
+         if (mRecords.end() == parent || parentHash == hash) {
+            mRecords.clear();
+            return Result<bool>{false, corrupt};
+         }
+         parent->second.children.push_back(hash);
+      }
+   }
+   if (offset != buffer.size() || mRecords.end() == mRecords.find(kRootHash)) {
+      mRecords.clear();
+      return Result<bool>{false, corrupt};
+   }
+   return Result<bool>{true};
+}
+} // namespace FileIO
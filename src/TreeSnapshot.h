@@ -0,0 +1,104 @@
+/*
+ * File:   TreeSnapshot.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "DirectoryReader.h"
+#include "Result.h"
+
+namespace FileIO {
+
+enum class ChangeType {Added, Removed, Modified};
+
+/// One change found by TreeSnapshot::Update
+struct TreeChange {
+   ChangeType change;
+   EntryType type;
+   std::string path;  ///< relative to the snapshot's root, e.g. "dir1/file_1"
+};
+
+struct SnapshotOptions {
+   /// Files in a directory whose modification time did not change are stat'ed, to find files
+   /// that were modified in place. Without it an unchanged directory costs one stat per
+   /// subdirectory and nothing per file, in-place modifications are then not found
+   bool statFiles = true;
+};
+
+/*
+ * TreeSnapshot is an index of a directory tree: for every entry the hash of its path,
+ * inode, size, modification time and type. Update() compares the tree with the snapshot,
+ * returns what was added, removed and modified and brings the snapshot up to date.
+ *
+ * A directory's modification time changes when entries are added, removed or renamed in it,
+ * so a directory whose inode and modification time did not change is not read again:
+ * its known entries are stat'ed instead, see SnapshotOptions. Its subdirectories must still
+ * be visited, a change deep in a tree does not show in the modification time of its parents.
+ * The cost of an Update is one stat per directory, plus a stat per file, plus reading the
+ * directories that changed.
+ *
+ * Directories that were modified too close to the previous scan, within the timestamp
+ * granularity of the file system, are always read again.
+ *
+ * The walk is like FileSystemWalker: symbolic links are not followed and subdirectories on
+ * other devices are recorded but not entered. Paths are told apart by a 64 bit FNV-1a hash.
+ */
+class TreeSnapshot {
+public:
+   TreeSnapshot();
+
+   Result<bool> Take(const std::string& root);
+   Result<std::vector<TreeChange>> Update(const SnapshotOptions& options = SnapshotOptions{});
+   Result<bool> Save(const std::string& snapshotFile) const;
+   Result<bool> Load(const std::string& snapshotFile);
+
+   const std::string& Root() const {
+      return mRoot;
+   }
+   size_t Entries() const {
+      return mRecords.size();
+   }
+
+private:
+   struct Record {
+      uint64_t parentHash;
+      ino64_t inode;
+      uint64_t size;
+      int64_t modifiedNs;
+      EntryType type;
+      std::string name;
+      std::vector<uint64_t> children; ///< path hashes, directories only
+   };
+
+   /// State of one Take or Update
+   struct Scan {
+      std::vector<TreeChange>* changes; ///< nullptr when taking a snapshot
+      SnapshotOptions options;
+      dev_t device;
+      int64_t racyFromNs;               ///< directories modified after this are always read
+   };
+
+   Result<bool> ScanTree(Scan& scan);
+   void VisitDirectory(std::string& path, const uint64_t hash, const bool listingChanged, Scan& scan);
+   bool StatKnownChildren(std::string& path, const int directoryFd, const uint64_t hash, Scan& scan);
+   void ListChildren(std::string& path, const int directoryFd, const uint64_t hash, Scan& scan);
+   void UpdateChild(std::string& path, const uint64_t parentHash, const std::string& name,
+                    const struct stat& info, Scan& scan, std::vector<uint64_t>& children);
+   void RemoveSubtree(const uint64_t hash, Scan& scan);
+   void Report(const ChangeType change, const uint64_t hash, Scan& scan) const;
+   std::string PathOf(uint64_t hash) const;
+   void SaveSubtree(const uint64_t hash, std::string& buffer) const;
+
+   std::string mRoot;
+   int64_t mTakenNs; ///< when the last scan started
+   std::unordered_map<uint64_t, Record> mRecords;
+};
+} // namespace FileIO
@@ -0,0 +1,191 @@
+/*
+ * File:   TreeUsage.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "TreeUsage.h"
+#include "FileSystemWalker.h"
+#include "ParallelFileSystemWalker.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fts.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include <cstring>
+
+namespace {
+   using FileIO::Usage;
+
+   /// Files with more than one link, by (st_dev, st_ino), shared by all the threads
+   struct HardLinks {
+      std::mutex lock;
+      std::set<std::pair<dev_t, ino_t>> seen;
+
+      /// @return true the first time the file is seen
+      bool FirstTime(const struct stat& info) {
+         std::lock_guard<std::mutex> guard(lock);
+         return seen.emplace(info.st_dev, info.st_ino).second;
+      }
+   };
+
+   /**
+    * The FTSENT handler of one thread. Every entry is counted in the bucket of the deepest
+    * directory above it, or itself for a directory, that gets a rollup. The buckets hold
+    * only what was counted directly in them, they are summed up the tree when the walk is done
+    */
+   class UsageCounter {
+   public:
+      UsageCounter(const std::string& root, const int maxDepth, HardLinks& hardLinks)
+      : mRoot(root)
+      , mMaxDepth(maxDepth)
+      , mHardLinks(hardLinks)
+      , mLast(buckets.end()) {
+      }
+
+      int operator()(FTSENT* node, int flag) {
+         Usage entry;
+         switch (flag) {
+            case FTS_D: entry.directories = 1;
+               break;
+            case FTS_F: entry.files = 1;
+               break;
+            case FTS_SL:
+            case FTS_SLNONE:
+            case FTS_DEFAULT: entry.others = 1;
+               break;
+            case FTS_DP:
+               return 0;
+            default: // FTS_DNR, FTS_NS, FTS_ERR, FTS_DC
+               ++unreadable;
+               return 0;
+         }
+
+         const struct stat& info = *node->fts_statp;
+         if (FTS_D != flag && info.st_nlink > 1 && !mHardLinks.FirstTime(info)) {
+            return 0;
+         }
+         entry.apparentBytes = info.st_size;
+         entry.allocatedBytes = static_cast<uint64_t> (info.st_blocks) * 512;
+         Bucket(node, flag).Add(entry);
+         return 0;
+      }
+
+      std::map<std::string, Usage> buckets;
+      uint64_t unreadable = 0;
+
+   private:
+      Usage& Bucket(const FTSENT* node, const int flag) {
+         int level = (FTS_D == flag) ? node->fts_level : node->fts_level - 1;
+         if (mMaxDepth >= 0 && level > mMaxDepth) {
+            level = mMaxDepth;
+         }
+
+         // the bucket's path is the root path followed by the first 'level' components
+         const char* path = node->fts_path;
+         const size_t length = node->fts_pathlen;
+         size_t end = mRoot.size();
+         size_t position = ("/" == mRoot) ? 0 : mRoot.size();
+         for (int component = 0; component < level && position < length; ++component) {
+            const char* separator = static_cast<const char*> (memchr(path + position + 1, '/', length - position - 1));
+            end = (nullptr == separator) ? length : separator - path;
+            position = end;
+         }
+
+         // entries come directory by directory, most of them are in the same bucket as the previous one
+         if (buckets.end() == mLast || mLast->first.size() != end || 0 != memcmp(mLast->first.data(), path, end)) {
+            mLast = buckets.emplace(std::string(path, end), Usage{}).first;
+         }
+         return mLast->second;
+      }
+
+      const std::string mRoot;
+      const int mMaxDepth;
+      HardLinks& mHardLinks;
+      std::map<std::string, Usage>::iterator mLast;
+   };
+
+   /// @return the parent directory of a path below the root
+   std::string Parent(const std::string& path) {
+      const size_t separator = path.rfind('/');
+      return (0 == separator) ? std::string{"/"} : path.substr(0, separator);
+   }
+} // anonymous helper
+
+
+namespace FileIO {
+
+/**
+ * Computes the disk usage of a directory tree, like du. Directories count with their own
+ * size, as with du.
+ *
+ * A file with several hard links is counted once, at the first link that is found, by
+ * (st_dev, st_ino). Symbolic links are not followed and the walk stays on the device of
+ * the start path, the same as FileSystemWalker.
+ *
+ * With more than one thread the tree is walked with ParallelFileSystemWalker. Every
+ * thread counts on its own, the counts are merged when the walk is done, so there is no
+ * shared state in the walk except the set of hard linked files.
+ *
+ * @param path the directory to compute the usage of
+ * @param options threads and rollup depth, see UsageOptions
+ * @return Result<TreeUsage> the usage and any possible error. The rollup of the path
+ *         itself is always there and is the same as the total
+ */
+Result<TreeUsage> ComputeTreeUsage(const std::string& path, const UsageOptions& options) {
+   // fts gives "dir/entry" for the start path "dir/"
+   std::string root = path;
+   while (root.size() > 1 && '/' == root.back()) {
+      root.pop_back();
+   }
+
+   HardLinks hardLinks;
+   std::mutex countersLock;
+   std::vector<std::shared_ptr<UsageCounter>> counters;
+   auto factory = [&]() -> ParallelFileSystemWalker::FtsHandler {
+      std::shared_ptr<UsageCounter> counter = std::make_shared<UsageCounter>(root, options.maxDepth, hardLinks);
+      {
+         std::lock_guard<std::mutex> guard(countersLock);
+         counters.push_back(counter);
+      }
+      return [counter](FTSENT* node, int flag) {
+         return (*counter)(node, flag);
+      };
+   };
+
+   if (options.threads > 1) {
+      ParallelFileSystemWalker walker(root, factory, options.threads);
+      auto walked = walker.Action();
+      if (walked.HasFailed()) {
+         return Result<TreeUsage>{TreeUsage{}, walked.error};
+      }
+   } else {
+      FileSystemWalker walker(root, factory());
+      auto walked = walker.Action();
+      if (walked.HasFailed()) {
+         return Result<TreeUsage>{TreeUsage{}, walked.error};
+      }
+   }
+
+   TreeUsage usage;
+   for (const auto& counter : counters) {
+      usage.unreadable += counter->unreadable;
+      for (const auto& bucket : counter->buckets) {
+         usage.directories[bucket.first].Add(bucket.second);
+      }
+   }
+
+   // every subdirectory sorts after its parent: going backwards the subtrees are summed before their parents
+   for (auto directory = usage.directories.rbegin(); directory != usage.directories.rend(); ++directory) {
+      if (root != directory->first) {
+         usage.directories[Parent(directory->first)].Add(directory->second);
+      }
+   }
+   usage.total = usage.directories[root];
+   return Result<TreeUsage>{usage};
+}
+} // namespace FileIO
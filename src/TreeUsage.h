@@ -0,0 +1,49 @@
+/*
+ * File:   TreeUsage.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include "Result.h"
+
+namespace FileIO {
+
+struct UsageOptions {
+   size_t threads = 1;  ///< more than one walks the tree with ParallelFileSystemWalker
+   /// Directories down to this depth get their own rollup, the start path is at depth 0.
+   /// Negative gives a rollup for every directory
+   int maxDepth = 0;
+};
+
+/// Usage of a directory tree, or of a directory and everything below it
+struct Usage {
+   uint64_t apparentBytes = 0;   ///< sum of st_size
+   uint64_t allocatedBytes = 0;  ///< sum of st_blocks * 512, what du reports
+   uint64_t files = 0;           ///< regular files
+   uint64_t directories = 0;
+   uint64_t others = 0;          ///< symbolic links, devices, fifos, sockets
+
+   void Add(const Usage& other) {
+      apparentBytes += other.apparentBytes;
+      allocatedBytes += other.allocatedBytes;
+      files += other.files;
+      directories += other.directories;
+      others += other.others;
+   }
+};
+
+struct TreeUsage {
+   Usage total;
+   /// directory path -> usage of the directory and its whole subtree, see UsageOptions::maxDepth
+   std::map<std::string, Usage> directories;
+   uint64_t unreadable = 0;      ///< entries that could not be stat'ed or read, they are not counted
+};
+
+Result<TreeUsage> ComputeTreeUsage(const std::string& path, const UsageOptions& options = UsageOptions{});
+} // namespace FileIO
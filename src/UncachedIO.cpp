@@ -0,0 +1,467 @@
+/*
+ * File:   UncachedIO.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "UncachedIO.h"
+#include "FileIO.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+   /// Used when the device does not tell, e.g. tmpfs and network file systems. Page size is always a safe alignment
+   const size_t kDefaultBlockSize = 4096;
+   const size_t kPoolBufferSize = 1024 * 1024;
+   const size_t kPoolMaxIdle = 8;
+
+   /// @return the size in the sysfs file, 0 if it cannot be read or is not a power of two between 512 bytes and 64KB
+   size_t ReadBlockSize(const std::string& sysfsFile) {
+      auto content = FileIO::ReadAsciiFileContent(sysfsFile);
+      if (content.HasFailed()) {
+         return 0;
+      }
+      const size_t size = strtoul(content.result.c_str(), nullptr, 10);
+      const bool powerOfTwo = (0 != size) && (0 == (size & (size - 1)));
+      return (powerOfTwo && size >= 512 && size <= 64 * 1024) ? size : 0;
+   }
+
+   /// pwrite of all the bytes, @return false with errno set if a write failed
+   bool WriteAllAt(const int fd, const uint8_t* data, size_t size, off_t offset) {
+      while (size > 0) {
+         const ssize_t written = pwrite(fd, data, size, offset);
+         if (-1 == written) {
+            if (EINTR == errno) {
+               continue;
+            }
+            return false;
+         }
+         data += written;
+         size -= static_cast<size_t> (written);
+         offset += written;
+      }
+      return true;
+   }
+
+   /// Reserves the next preallocateBytes past the end of the file when the append would not fit in the blocks already allocated
+   void ReserveAhead(const int fd, const struct stat& fileInfo, const size_t appendBytes, const size_t preallocateBytes) {
+      if (0 == preallocateBytes || 0 == appendBytes) {
+         return;
+      }
+      const off_t allocated = static_cast<off_t> (fileInfo.st_blocks) * 512;
+      if (fileInfo.st_size + static_cast<off_t> (appendBytes) > allocated) {
+         const size_t bytes = std::max(preallocateBytes, appendBytes);
+         FileIO::PreallocateRange(fd, fileInfo.st_size, bytes, FileIO::PreallocateMode::KeepSize);
+      }
+   }
+
+   /// Buffered read of a regular file with the posix_fadvise hints of the options
+   Result<std::vector<uint8_t>> ReadWithAdvice(const std::string& pathToFile, const FileIO::IOOptions& options) {
+      FileIO::ScopedFileDescriptor file(pathToFile, O_RDONLY | O_CLOEXEC, 0);
+      struct stat fileInfo;
+      if (-1 == file.fd || 0 != fstat(file.fd, &fileInfo) || !S_ISREG(fileInfo.st_mode) || 0 == fileInfo.st_size) {
+         return FileIO::ReadBinaryFileContent(pathToFile); // the same errors, hints are for regular files
+      }
+      if (FileIO::ReadAdvice::Normal != options.readAdvice) {
+         const bool sequential = (FileIO::ReadAdvice::Sequential == options.readAdvice);
+         posix_fadvise(file.fd, 0, 0, sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_WILLNEED);
+      }
+
+      std::vector<uint8_t> contents(static_cast<size_t> (fileInfo.st_size));
+      size_t bytesRead = 0;
+      while (bytesRead < contents.size()) {
+         const ssize_t rc = pread(file.fd, contents.data() + bytesRead, contents.size() - bytesRead, bytesRead);
+         if (-1 == rc) {
+            if (EINTR == errno) {
+               continue;
+            }
+            return Result<std::vector<uint8_t>>{{}, {"Failed to read file: " + pathToFile + ", error: " + std::strerror(errno)}};
+         }
+         if (0 == rc) {
+            break;
+         }
+         bytesRead += static_cast<size_t> (rc);
+      }
+      contents.resize(bytesRead);
+      if (options.dropAfterRead) {
+         posix_fadvise(file.fd, 0, 0, POSIX_FADV_DONTNEED);
+      }
+      return Result<std::vector<uint8_t>>{std::move(contents)};
+   }
+
+   /// Buffered append. With preallocation it is written through a descriptor that the space is reserved on first
+   Result<bool> AppendBuffered(const std::string& filename, const std::vector<uint8_t>& content, const FileIO::IOOptions& options) {
+      if (0 == options.preallocateBytes || content.empty()) {
+         return FileIO::WriteAppendBinaryFileContent(filename, content);
+      }
+      const std::string error{"Unable to write test data to file: " + filename};
+      FileIO::ScopedFileDescriptor file(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+      struct stat fileInfo;
+      if (-1 == file.fd || 0 != fstat(file.fd, &fileInfo)) {
+         return Result<bool>{false, error + ", error: " + std::strerror(errno)};
+      }
+      ReserveAhead(file.fd, fileInfo, content.size(), options.preallocateBytes);
+      struct iovec buffer{const_cast<uint8_t*> (content.data()), content.size()};
+      const int writeError = FileIO::WriteVectored(file.fd, &buffer, 1);
+      if (0 != writeError) {
+         return Result<bool>{false, error + ", error: " + std::strerror(writeError)};
+      }
+      return Result<bool>{true};
+   }
+
+   /// WriteGather or AppendGather (mode O_TRUNC or O_APPEND) of the content, with its errors, through a descriptor that the space is reserved on first
+   Result<bool> WriteAsciiReserved(const std::string& pathToFile, const std::string& content, const int mode, const size_t preallocateBytes) {
+      FileIO::ScopedFileDescriptor file(pathToFile, O_WRONLY | O_CREAT | O_CLOEXEC | mode, 0666);
+      struct stat fileInfo;
+      if (-1 == file.fd || 0 != fstat(file.fd, &fileInfo)) {
+         return Result<bool>{false, {"Cannot write-open file: " + pathToFile + ", error: " + std::strerror(errno)}};
+      }
+      ReserveAhead(file.fd, fileInfo, content.size(), preallocateBytes);
+      struct iovec buffer{const_cast<char*> (content.data()), content.size()};
+      const int writeError = FileIO::WriteVectored(file.fd, &buffer, 1);
+      if (0 != writeError) {
+         return Result<bool>{false, {"Unable to write to file: " + pathToFile + ", error: " + std::strerror(writeError)}};
+      }
+      return Result<bool>{true};
+   }
+
+   /// The append of WriteAppendBinaryFileContentWithOptions, without the page cache handling
+   Result<bool> AppendWithOptions(const std::string& filename, const std::vector<uint8_t>& content, const FileIO::IOOptions& options) {
+      if (!options.directIO || content.empty()) {
+         return AppendBuffered(filename, content, options);
+      }
+
+      const std::string error{"Unable to write test data to file: " + filename};
+      FileIO::ScopedFileDescriptor direct(filename, O_WRONLY | O_CREAT | O_CLOEXEC | O_DIRECT, 0666);
+      if (-1 == direct.fd) {
+         if (EINVAL == errno) {
+            return AppendBuffered(filename, content, options);
+         }
+         return Result<bool>{false, error + ", error: " + std::strerror(errno)};
+      }
+      FileIO::ScopedFileDescriptor buffered(filename, O_WRONLY | O_CLOEXEC, 0);
+      struct stat fileInfo;
+      if (-1 == buffered.fd || 0 != fstat(direct.fd, &fileInfo)) {
+         return Result<bool>{false, error + ", error: " + std::strerror(errno)};
+      }
+      ReserveAhead(direct.fd, fileInfo, content.size(), options.preallocateBytes);
+
+      const size_t blockSize = FileIO::LogicalBlockSize(direct.fd);
+      const uint8_t* data = content.data();
+      const size_t size = content.size();
+      off_t offset = fileInfo.st_size;
+      size_t written = 0;
+
+      const size_t misalignment = static_cast<size_t> (offset) % blockSize;
+      const size_t head = (0 == misalignment) ? 0 : std::min(blockSize - misalignment, size);
+      if (!WriteAllAt(buffered.fd, data, head, offset)) {
+         return Result<bool>{false, error + ", error: " + std::strerror(errno)};
+      }
+      written += head;
+      offset += head;
+
+      auto lease = FileIO::DirectIOBufferPool().Acquire();
+      FileIO::AlignedBuffer& buffer = lease.Buffer();
+      const size_t chunkLimit = buffer.Valid() ? buffer.Size() / blockSize * blockSize : 0;
+      while (chunkLimit > 0 && size - written >= blockSize) {
+         const size_t chunk = std::min(chunkLimit, (size - written) / blockSize * blockSize);
+         memcpy(buffer.Data(), data + written, chunk);
+         const ssize_t bytesWritten = pwrite(direct.fd, buffer.Data(), chunk, offset);
+         if (-1 == bytesWritten) {
+            if (EINTR == errno) {
+               continue;
+            }
+            if (EINVAL == errno) {
+               break; // the rest is written buffered
+            }
+            return Result<bool>{false, error + ", error: " + std::strerror(errno)};
+         }
+         written += static_cast<size_t> (bytesWritten);
+         offset += bytesWritten;
+         if (0 != static_cast<size_t> (bytesWritten) % blockSize) {
+            break; // a short write leaves the offset unaligned
+         }
+      }
+
+      if (!WriteAllAt(buffered.fd, data + written, size - written, offset)) {
+         return Result<bool>{false, error + ", error: " + std::strerror(errno)};
+      }
+      return Result<bool>{true};
+   }
+
+   /// Flushes the file from start to its end and drops it from the page cache, for IOOptions::dropAfterWrite
+   void DropWrittenFrom(const std::string& filename, const off_t start) {
+      FileIO::ScopedFileDescriptor file(filename, O_RDONLY | O_CLOEXEC, 0);
+      if (-1 != file.fd) {
+         FileIO::DropFromPageCache(file.fd, start, 0);
+      }
+   }
+
+   /// @return the size of the file, 0 if it does not exist
+   off_t FileSize(const std::string& filename) {
+      struct stat fileInfo;
+      return (0 == stat(filename.c_str(), &fileInfo)) ? fileInfo.st_size : 0;
+   }
+} // anonymous helper
+
+
+namespace FileIO {
+
+/**
+ * @param bufferSize size of every buffer, a multiple of any device's logical block size
+ * @param maxPooled idle buffers kept for reuse, more buffers than this can be leased at once
+ */
+AlignedBufferPool::AlignedBufferPool(const size_t bufferSize, const size_t maxPooled)
+: mBufferSize(bufferSize)
+, mMaxPooled(maxPooled) {
+}
+
+/// @return a leased buffer, from the pool when there is one. Its Valid() is false if the allocation failed
+AlignedBufferPool::Lease AlignedBufferPool::Acquire() {
+   {
+      std::lock_guard<std::mutex> lock(mLock);
+      if (!mIdle.empty()) {
+         AlignedBuffer buffer{std::move(mIdle.back())};
+         mIdle.pop_back();
+         return Lease{*this, std::move(buffer)};
+      }
+   }
+   return Lease{*this, AlignedBuffer{mBufferSize}};
+}
+
+void AlignedBufferPool::Release(AlignedBuffer buffer) {
+   std::lock_guard<std::mutex> lock(mLock);
+   if (mIdle.size() < mMaxPooled) {
+      mIdle.push_back(std::move(buffer));
+   }
+}
+
+/**
+ * @param fd file that is written sequentially
+ * @param window bytes between sync_file_range calls
+ */
+WriteBehind::WriteBehind(const int fd, const size_t window)
+: mFd(fd)
+, mWindow(window)
+, mStart(0)
+, mEnd(0)
+, mFlushingStart(0)
+, mFlushingEnd(0) {
+}
+
+/// Call after every write. A write that does not continue the previous one starts a new window
+void WriteBehind::Written(const off_t offset, const size_t length) {
+   if (mStart == mEnd) {
+      mStart = offset;
+      mEnd = offset;
+   } else if (offset != mEnd) {
+      Start();
+      mStart = offset;
+      mEnd = offset;
+   }
+   mEnd += length;
+   if (static_cast<size_t> (mEnd - mStart) >= mWindow) {
+      Start();
+   }
+}
+
+/// Flushes and drops everything that was written, the writer must call it when it is done
+void WriteBehind::Finish() {
+   if (mStart != mEnd) {
+      Start();
+   }
+   if (mFlushingStart != mFlushingEnd) {
+      Drop(mFlushingStart, mFlushingEnd);
+      mFlushingStart = mFlushingEnd;
+   }
+}
+
+/// Starts the writeback of the current window without waiting, and drops the previous window
+void WriteBehind::Start() {
+   sync_file_range(mFd, mStart, mEnd - mStart, SYNC_FILE_RANGE_WRITE);
+   if (mFlushingStart != mFlushingEnd) {
+      Drop(mFlushingStart, mFlushingEnd);
+   }
+   mFlushingStart = mStart;
+   mFlushingEnd = mEnd;
+   mStart = mEnd;
+}
+
+void WriteBehind::Drop(const off_t offset, const off_t end) {
+   DropFromPageCache(mFd, offset, end - offset);
+}
+
+/**
+ * Waits for the range to be written back and drops it from the page cache. Only whole
+ * pages inside the range are dropped
+ * @param length bytes from the offset, zero means to the end of the file
+ */
+void DropFromPageCache(const int fd, const off_t offset, const size_t length) {
+   sync_file_range(fd, offset, length, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+   posix_fadvise(fd, offset, length, POSIX_FADV_DONTNEED);
+}
+
+/// @return the pool used by the direct I/O functions, 1MB page aligned buffers
+AlignedBufferPool& DirectIOBufferPool() {
+   static AlignedBufferPool pool(kPoolBufferSize, kPoolMaxIdle);
+   return pool;
+}
+
+/**
+ * The logical block size of the device a file is on, from
+ * /sys/dev/block/<major>:<minor>/queue/logical_block_size. For a partition it is read
+ * from the whole disk. Direct I/O offsets and sizes must be multiples of it
+ * @return the logical block size, 4096 when the device does not tell (tmpfs, NFS, ...)
+ */
+size_t LogicalBlockSize(const int fd) {
+   struct stat info;
+   if (0 != fstat(fd, &info)) {
+      return kDefaultBlockSize;
+   }
+   const std::string device{"/sys/dev/block/" + std::to_string(major(info.st_dev)) + ":" + std::to_string(minor(info.st_dev))};
+   size_t size = ReadBlockSize(device + "/queue/logical_block_size");
+   if (0 == size) {
+      size = ReadBlockSize(device + "/../queue/logical_block_size");
+   }
+   return (0 == size) ? kDefaultBlockSize : size;
+}
+
+/**
+ * ReadBinaryFileContent, optionally with direct I/O. The file is read into pooled aligned
+ * buffers and copied out, the page cache is not filled with it. Without direct I/O the
+ * read can be given a readahead hint and be dropped from the page cache afterwards.
+ * Falls back to ReadBinaryFileContent when the file system rejects O_DIRECT (EINVAL)
+ * and for files that are not regular files
+ *
+ * @param pathToFile to read
+ * @param options see IOOptions
+ * @return Result<std::vector<uint8_t>> all the content of the file, and/or an error string
+ */
+Result<std::vector<uint8_t>> ReadBinaryFileContentWithOptions(const std::string& pathToFile, const IOOptions& options) {
+   if (!options.directIO) {
+      if (ReadAdvice::Normal == options.readAdvice && !options.dropAfterRead) {
+         return ReadBinaryFileContent(pathToFile);
+      }
+      return ReadWithAdvice(pathToFile, options);
+   }
+
+   ScopedFileDescriptor file(pathToFile, O_RDONLY | O_CLOEXEC | O_DIRECT, 0);
+   if (-1 == file.fd) {
+      if (EINVAL == errno) {
+         return ReadBinaryFileContent(pathToFile);
+      }
+      return Result<std::vector<uint8_t>>{{}, {"Cannot read-open file: " + pathToFile}};
+   }
+   struct stat fileInfo;
+   if (0 != fstat(file.fd, &fileInfo)) {
+      return Result<std::vector<uint8_t>>{{}, {"Cannot stat file: " + pathToFile + ", error: " + std::strerror(errno)}};
+   }
+   auto lease = DirectIOBufferPool().Acquire();
+   if (!S_ISREG(fileInfo.st_mode) || !lease.Buffer().Valid()) {
+      return ReadBinaryFileContent(pathToFile);
+   }
+
+   AlignedBuffer& buffer = lease.Buffer();
+   const size_t size = static_cast<size_t> (fileInfo.st_size);
+   std::vector<uint8_t> contents(size);
+   size_t offset = 0;
+   while (offset < size) {
+      const ssize_t bytesRead = pread(file.fd, buffer.Data(), buffer.Size(), offset);
+      if (-1 == bytesRead) {
+         if (EINTR == errno) {
+            continue;
+         }
+         if (EINVAL == errno && 0 == offset) {
+            return ReadBinaryFileContent(pathToFile); // O_DIRECT was accepted at open but not for reads
+         }
+         return Result<std::vector<uint8_t>>{{}, {"Failed to read file: " + pathToFile + ", error: " + std::strerror(errno)}};
+      }
+      const size_t useful = std::min(static_cast<size_t> (bytesRead), size - offset);
+      memcpy(contents.data() + offset, buffer.Data(), useful);
+      offset += useful;
+      if (static_cast<size_t> (bytesRead) < buffer.Size()) {
+         break; // EOF, the file was read as far as st_size like ReadBinaryFileContent
+      }
+   }
+   contents.resize(offset);
+   return Result<std::vector<uint8_t>>{std::move(contents)};
+}
+
+/**
+ * WriteAppendBinaryFileContent, optionally with direct I/O. The whole blocks are written
+ * with O_DIRECT through pooled aligned buffers. The unaligned head, up to the first block
+ * boundary after the current end of the file, and the unaligned tail are written buffered,
+ * they are less than two blocks.
+ * Falls back to WriteAppendBinaryFileContent when the file system rejects O_DIRECT, and
+ * to buffered writes for the rest of the content if a direct write is rejected.
+ *
+ * The append is not atomic: it is for files with one writer, as archives and spools are.
+ * With dropAfterWrite the appended range is flushed and dropped from the page cache.
+ * With preallocateBytes the blocks past the end of the file are reserved ahead of the appends
+ *
+ * @param filename to append to, it is created if it does not exist
+ * @param content to append
+ * @param options see IOOptions
+ * @return Result<bool> with an error string if the write failed
+ */
+Result<bool> WriteAppendBinaryFileContentWithOptions(const std::string& filename, const std::vector<uint8_t>& content, const IOOptions& options) {
+   if (!options.dropAfterWrite || content.empty()) {
+      return AppendWithOptions(filename, content, options);
+   }
+   const off_t start = FileSize(filename);
+   auto appended = AppendWithOptions(filename, content, options);
+   if (!appended.HasFailed()) {
+      DropWrittenFrom(filename, start);
+   }
+   return appended;
+}
+
+/**
+ * WriteAsciiFileContent, with IOOptions::dropAfterWrite: the file is flushed and dropped
+ * from the page cache once it is written, and IOOptions::preallocateBytes. The other
+ * options are for the binary functions
+ */
+Result<bool> WriteAsciiFileContentWithOptions(const std::string& pathToFile, const std::string& content, const IOOptions& options) {
+   auto written = (0 == options.preallocateBytes) ? WriteAsciiFileContent(pathToFile, content)
+                                                  : WriteAsciiReserved(pathToFile, content, O_TRUNC, options.preallocateBytes);
+   if (options.dropAfterWrite && !written.HasFailed()) {
+      DropWrittenFrom(pathToFile, 0);
+   }
+   return written;
+}
+
+/// AppendWriteAsciiFileContent, with IOOptions::dropAfterWrite for the appended range and IOOptions::preallocateBytes
+Result<bool> AppendWriteAsciiFileContentWithOptions(const std::string& pathToFile, const std::string& content, const IOOptions& options) {
+   const off_t start = options.dropAfterWrite ? FileSize(pathToFile) : 0;
+   auto appended = (0 == options.preallocateBytes) ? AppendWriteAsciiFileContent(pathToFile, content)
+                                                   : WriteAsciiReserved(pathToFile, content, O_APPEND, options.preallocateBytes);
+   if (options.dropAfterWrite && !appended.HasFailed()) {
+      DropWrittenFrom(pathToFile, start);
+   }
+   return appended;
+}
+
+/// WriteFileAtomically, with IOOptions::dropAfterWrite for the new content and IOOptions::preallocateBytes for the temporary file
+Result<bool> WriteFileAtomicallyWithOptions(const std::string& pathToFile, const std::string& content, const Durability durability,
+                                            const IOOptions& options) {
+   auto written = WriteFileAtomicallyInternal(pathToFile, content, durability, [&](const int fd) {
+      struct stat fileInfo;
+      if (0 == fstat(fd, &fileInfo)) {
+         ReserveAhead(fd, fileInfo, content.size(), options.preallocateBytes);
+      }
+   });
+   if (options.dropAfterWrite && !written.HasFailed()) {
+      DropWrittenFrom(pathToFile, 0);
+   }
+   return written;
+}
+
+} // namespace FileIO
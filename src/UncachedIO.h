@@ -0,0 +1,129 @@
+/*
+ * File:   UncachedIO.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+#include "AlignedBuffer.h"
+#include "FileIO.h"
+#include "Result.h"
+
+/*
+ * Bulk reads and writes that keep out of the page cache, so that archiving or loading
+ * large files does not evict the hot working set of the rest of the process.
+ */
+namespace FileIO {
+
+/// posix_fadvise hint for a buffered read
+enum class ReadAdvice {
+   Normal,
+   Sequential, ///< POSIX_FADV_SEQUENTIAL: larger readahead
+   WillNeed    ///< POSIX_FADV_WILLNEED: the whole file is read ahead at once
+};
+
+struct IOOptions {
+   /// O_DIRECT: the data goes between the device and an aligned buffer, not through the
+   /// page cache. Falls back to buffered I/O where the file system rejects O_DIRECT
+   bool directIO = false;
+   ReadAdvice readAdvice = ReadAdvice::Normal;
+   /// POSIX_FADV_DONTNEED once the file was read. Also drops pages that were cached before the read
+   bool dropAfterRead = false;
+   /// the written range is flushed with sync_file_range and dropped with POSIX_FADV_DONTNEED.
+   /// With preallocateBytes the only options of the ascii and atomic *WithOptions writes
+   bool dropAfterWrite = false;
+   /// when a write does not fit in the blocks allocated to the file, the next preallocateBytes
+   /// past the end are reserved with fallocate. Small appends then fill one contiguous extent.
+   /// The reserved blocks stay allocated until the file is truncated. Zero disables it
+   size_t preallocateBytes = 0;
+};
+
+/**
+ * Keeps a sequential writer from filling the page cache with dirty pages: every written
+ * window is started with sync_file_range, and when the next window is written the previous
+ * one is waited for and dropped with POSIX_FADV_DONTNEED. At most two windows are cached.
+ * sync_file_range does not flush metadata, it is not a replacement for fdatasync
+ */
+class WriteBehind {
+public:
+   static const size_t kDefaultWindow = 8 * 1024 * 1024;
+
+   explicit WriteBehind(const int fd, const size_t window = kDefaultWindow);
+   void Written(const off_t offset, const size_t length);
+   void Finish();
+
+   WriteBehind(const WriteBehind&) = delete;
+   WriteBehind& operator=(const WriteBehind&) = delete;
+private:
+   void Start();
+   void Drop(const off_t offset, const off_t end);
+
+   const int mFd;
+   const size_t mWindow;
+   off_t mStart;    ///< written, not yet started
+   off_t mEnd;
+   off_t mFlushingStart; ///< started, not yet dropped
+   off_t mFlushingEnd;
+};
+
+/**
+ * Pool of equally sized, aligned buffers for direct I/O. A Lease hands its buffer back
+ * to the pool when it goes out of scope, the pool keeps at most maxPooled idle buffers
+ */
+class AlignedBufferPool {
+public:
+   class Lease {
+   public:
+      Lease(AlignedBufferPool& pool, AlignedBuffer buffer) : mPool(pool), mBuffer(std::move(buffer)) {}
+      Lease(Lease&&) = default;
+      ~Lease() {
+         if (mBuffer.Valid()) {
+            mPool.Release(std::move(mBuffer));
+         }
+      }
+      AlignedBuffer& Buffer() {
+         return mBuffer;
+      }
+
+      Lease(const Lease&) = delete;
+      Lease& operator=(const Lease&) = delete;
+   private:
+      AlignedBufferPool& mPool;
+      AlignedBuffer mBuffer;
+   };
+
+   AlignedBufferPool(const size_t bufferSize, const size_t maxPooled);
+   Lease Acquire();
+   size_t BufferSize() const {
+      return mBufferSize;
+   }
+
+   AlignedBufferPool(const AlignedBufferPool&) = delete;
+   AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+private:
+   void Release(AlignedBuffer buffer);
+
+   const size_t mBufferSize;
+   const size_t mMaxPooled;
+   std::mutex mLock;
+   std::vector<AlignedBuffer> mIdle;
+};
+
+AlignedBufferPool& DirectIOBufferPool();
+size_t LogicalBlockSize(const int fd);
+
+Result<std::vector<uint8_t>> ReadBinaryFileContentWithOptions(const std::string& pathToFile, const IOOptions& options);
+void DropFromPageCache(const int fd, const off_t offset, const size_t length);
+Result<bool> WriteAppendBinaryFileContentWithOptions(const std::string& filename, const std::vector<uint8_t>& content, const IOOptions& options);
+Result<bool> WriteAsciiFileContentWithOptions(const std::string& pathToFile, const std::string& content, const IOOptions& options);
+Result<bool> AppendWriteAsciiFileContentWithOptions(const std::string& pathToFile, const std::string& content, const IOOptions& options);
+Result<bool> WriteFileAtomicallyWithOptions(const std::string& pathToFile, const std::string& content, const Durability durability,
+                                            const IOOptions& options);
+} // namespace FileIO
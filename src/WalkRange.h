@@ -0,0 +1,108 @@
+/*
+ * File:   WalkRange.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <iterator>
+#include <cstddef>
+#include "FileSystemWalker.h"
+
+/// Filter for WalkRange that lets every entry through
+struct AcceptAll {
+   bool operator()(const FTSENT&) const {
+      return true;
+   }
+};
+
+/*
+ * WalkRange gives input iterators over the entries of a WalkCursor, for range-based for
+ * loops and the standard algorithms. The filter is a template parameter so that it can be
+ * inlined, there is no std::function call per entry as with FileSystemWalker.
+ *
+ * The range does not own the cursor. Breaking out of a loop leaves the cursor at the
+ * last entry that was seen, the next begin() continues with the entry after it.
+ * A directory can be pruned with FileSystemWalker::SkipSubtree on its FTS_D entry.
+ *
+ * Example usage:
+   @verbatim
+   WalkCursor cursor{path, options};
+   for (FTSENT& entry : MakeWalkRange(cursor, [](const FTSENT& e) { return FTS_F == e.fts_info; })) {
+      ...
+   }
+   @endverbatim
+ */
+template<typename Filter = AcceptAll>
+class WalkRange {
+public:
+   class Iterator {
+   public:
+      typedef std::input_iterator_tag iterator_category;
+      typedef FTSENT value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef FTSENT* pointer;
+      typedef FTSENT& reference;
+
+      Iterator() : mRange(nullptr), mEntry(nullptr) {}
+      Iterator(WalkRange* range, FTSENT* entry) : mRange(range), mEntry(entry) {}
+
+      reference operator*() const {
+         return *mEntry;
+      }
+      pointer operator->() const {
+         return mEntry;
+      }
+      Iterator& operator++() {
+         mEntry = mRange->Advance();
+         return *this;
+      }
+      // Input iterator: the entry of the returned copy is only valid until the next increment
+      Iterator operator++(int) {
+         Iterator previous = *this;
+         ++(*this);
+         return previous;
+      }
+      bool operator==(const Iterator& other) const {
+         return mEntry == other.mEntry;
+      }
+      bool operator!=(const Iterator& other) const {
+         return mEntry != other.mEntry;
+      }
+
+   private:
+      WalkRange* mRange;
+      FTSENT* mEntry;
+   };
+
+   WalkRange(WalkCursor& cursor, Filter filter) : mCursor(cursor), mFilter(filter) {}
+
+   /// Continues the walk of the cursor, the first entry is the one after the cursor's current entry
+   Iterator begin() {
+      return Iterator{this, Advance()};
+   }
+   Iterator end() {
+      return Iterator{};
+   }
+
+private:
+   FTSENT* Advance() {
+      FTSENT* entry = nullptr;
+      while ((entry = mCursor.Next()) != nullptr && !mFilter(*entry)) {
+      }
+      return entry;
+   }
+
+   WalkCursor& mCursor;
+   Filter mFilter;
+};
+
+template<typename Filter>
+WalkRange<Filter> MakeWalkRange(WalkCursor& cursor, Filter filter) {
+   return WalkRange<Filter>{cursor, filter};
+}
+
+inline WalkRange<AcceptAll> MakeWalkRange(WalkCursor& cursor) {
+   return WalkRange<AcceptAll>{cursor, AcceptAll{}};
+}
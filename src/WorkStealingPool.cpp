@@ -0,0 +1,129 @@
+/*
+ * File:   WorkStealingPool.cpp
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+/// Identifies the pool and the queue of the current worker thread, if any
+thread_local const FileIO::WorkStealingPool* tCurrentPool = nullptr;
+thread_local size_t tCurrentQueue = 0;
+} // anonymous helper
+
+
+namespace FileIO {
+
+/// @param threads number of workers, at least one
+WorkStealingPool::WorkStealingPool(const size_t threads)
+   : mQueues()
+   , mWorkers()
+   , mQueued(0)
+   , mPending(0)
+   , mNextQueue(0)
+   , mStop(false) {
+   const size_t workers = std::max(threads, size_t{1});
+   for (size_t index = 0; index < workers; ++index) {
+      mQueues.emplace_back(new Queue);
+   }
+   for (size_t index = 0; index < workers; ++index) {
+      mWorkers.emplace_back(&WorkStealingPool::Run, this, index);
+   }
+}
+
+/// Finishes all submitted tasks before the workers are stopped
+WorkStealingPool::~WorkStealingPool() {
+   Wait();
+   {
+      std::lock_guard<std::mutex> lock(mSleepLock);
+      mStop = true;
+   }
+   mWorkAvailable.notify_all();
+   for (auto& worker : mWorkers) {
+      worker.join();
+   }
+}
+
+/**
+ * Queue a task. A task submitted by a worker of this pool goes to the back of that
+ * worker's own queue, others are spread over all queues
+ */
+void WorkStealingPool::Submit(Task task) {
+   const size_t index = (this == tCurrentPool) ? tCurrentQueue : (mNextQueue++ % mQueues.size());
+   ++mPending;
+   {
+      // counted before it is queued so that mQueued never drops below zero. The sleep
+      // lock makes sure that a worker that just found nothing to do is already waiting
+      std::lock_guard<std::mutex> lock(mSleepLock);
+      ++mQueued;
+   }
+   {
+      std::lock_guard<std::mutex> lock(mQueues[index]->lock);
+      mQueues[index]->tasks.push_back(std::move(task));
+   }
+   mWorkAvailable.notify_one();
+}
+
+/// Blocks until every submitted task is finished. Must not be called from a task
+void WorkStealingPool::Wait() {
+   std::unique_lock<std::mutex> lock(mSleepLock);
+   mAllDone.wait(lock, [&] {
+      return (0 == mPending);
+   });
+}
+
+/// Takes the newest task of the own queue or else the oldest task of another queue
+bool WorkStealingPool::PopOrSteal(const size_t index, Task& task) {
+   {
+      Queue& own = *mQueues[index];
+      std::lock_guard<std::mutex> lock(own.lock);
+      if (!own.tasks.empty()) {
+         task = std::move(own.tasks.back());
+         own.tasks.pop_back();
+         --mQueued;
+         return true;
+      }
+   }
+
+   for (size_t offset = 1; offset < mQueues.size(); ++offset) {
+      Queue& victim = *mQueues[(index + offset) % mQueues.size()];
+      std::lock_guard<std::mutex> lock(victim.lock);
+      if (!victim.tasks.empty()) {
+         task = std::move(victim.tasks.front());
+         victim.tasks.pop_front();
+         --mQueued;
+         return true;
+      }
+   }
+   return false;
+}
+
+void WorkStealingPool::Run(const size_t index) {
+   tCurrentPool = this;
+   tCurrentQueue = index;
+
+   Task task;
+   while (true) {
+      if (PopOrSteal(index, task)) {
+         task();
+         task = nullptr;
+         if (0 == --mPending) {
+            std::lock_guard<std::mutex> lock(mSleepLock);
+            mAllDone.notify_all();
+         }
+         continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mSleepLock);
+      mWorkAvailable.wait(lock, [&] {
+         return (mStop || mQueued > 0);
+      });
+      if (mStop && 0 == mQueued) {
+         return;
+      }
+   }
+}
+} // namespace FileIO
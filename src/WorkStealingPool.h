@@ -0,0 +1,65 @@
+/*
+ * File:   WorkStealingPool.h
+ *
+ * https://github.com/weberr13/FileIO
+ * Created on October 17, 2026
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FileIO {
+
+/**
+ * Thread pool for recursive work such as walking a directory tree, where each task
+ * may submit new tasks. Every worker has its own deque: it pushes and pops at the back
+ * (depth first, good locality) and when it runs dry it steals from the front of the
+ * other workers' deques (the oldest, typically largest, subtrees).
+ *
+ * Tasks submitted from outside the pool are spread round robin over the workers.
+ * Wait() blocks until all tasks, including the ones they submitted, are done.
+ */
+class WorkStealingPool {
+public:
+   typedef std::function<void()> Task;
+
+   explicit WorkStealingPool(const size_t threads);
+   ~WorkStealingPool();
+
+   void Submit(Task task);
+   void Wait();
+   size_t Threads() const {
+      return mWorkers.size();
+   }
+
+   WorkStealingPool() = delete;
+   WorkStealingPool(const WorkStealingPool&) = delete;
+   WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+private:
+   struct Queue {
+      std::mutex lock;
+      std::deque<Task> tasks;
+   };
+
+   void Run(const size_t index);
+   bool PopOrSteal(const size_t index, Task& task);
+
+   std::vector<std::unique_ptr<Queue>> mQueues;
+   std::vector<std::thread> mWorkers;
+   std::atomic<size_t> mQueued;    ///< tasks waiting in any of the queues
+   std::atomic<size_t> mPending;   ///< tasks submitted but not yet finished
+   std::atomic<size_t> mNextQueue; ///< round robin for submits from outside the pool
+   bool mStop;
+   std::mutex mSleepLock;
+   std::condition_variable mWorkAvailable;
+   std::condition_variable mAllDone;
+};
+} // namespace FileIO
@@ -13,13 +13,52 @@
 #include <future>
 #include <thread>
 #include <sstream>
+#include <map>
+#include <atomic>
+#include <new>
+#include <stdexcept>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+#include <climits>
 #include "ToolsTestFileIO.h"
 #include "FileIO.h"
 #include "DirectoryReader.h"
+#include "DirectoryListing.h"
 #include "FileSystemWalker.h"
+#include "FileChunkReader.h"
+#include "BinaryAppender.h"
+#include "FileCopy.h"
+#include "WorkStealingPool.h"
+#include "BatchRead.h"
+#include "AsyncFileIO.h"
+#include "UncachedIO.h"
 #include "StopWatch.h"
 
+// Counts every heap allocation made through operator new. Used by the
+// DISABLED_ performance tests to report allocations per call.
+// noinline: keeps GCC from pairing an inlined 'new' with 'free' and warning about it
+static std::atomic<size_t> gHeapAllocations{0};
+__attribute__((noinline)) void* operator new(size_t size) {
+   ++gHeapAllocations;
+   void* memory = malloc(size == 0 ? 1 : size);
+   if (nullptr == memory) {
+      throw std::bad_alloc();
+   }
+   return memory;
+}
+
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+   free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, size_t) noexcept {
+   free(memory);
+}
+
 namespace {
    // Random integer function from http://www2.research.att.com/~bs/C++0xFAQ.html#std-random
 
@@ -128,6 +167,195 @@ TEST_F(TestFileIO, WriteThenReadBinaryFileContent__Convert_uint8_to_char_should_
    EXPECT_TRUE(equalCharVectors) << "deadbeef.size(): " << deadbeef.size() << ", resultRead.size(): " << resultRead.result.size();
 }
 
+TEST_F(TestFileIO, ReadMappedFileContent__RegularFileIsMapped) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+
+   const std::vector<uint8_t> deadbeef{0xde, 0xad, 0xbe, 0xef};
+   EXPECT_FALSE(FileIO::WriteAppendBinaryFileContent(filename, deadbeef).HasFailed());
+
+   auto mapped = FileIO::ReadMappedFileContent(filename);
+   ASSERT_FALSE(mapped.HasFailed()) << mapped.error;
+   EXPECT_TRUE(mapped.result.IsMapped());
+   ASSERT_EQ(mapped.result.Size(), deadbeef.size());
+   EXPECT_TRUE(std::equal(deadbeef.begin(), deadbeef.end(), mapped.result.begin()));
+   EXPECT_FALSE(mapped.result.Advise(FileIO::MappedFile::Advice::Random).HasFailed());
+}
+
+TEST_F(TestFileIO, ReadMappedFileContent__ProcFileFallsBackToBufferedRead) {
+   auto mapped = FileIO::ReadMappedFileContent({"/proc/stat"});
+   ASSERT_FALSE(mapped.HasFailed()) << mapped.error;
+   EXPECT_FALSE(mapped.result.IsMapped());
+   EXPECT_FALSE(mapped.result.Empty());
+}
+
+TEST_F(TestFileIO, ReadMappedFileContent__CannotOpenFile) {
+   auto mapped = FileIO::ReadMappedFileContent({"/xyz/*&%/x.y.z"});
+   EXPECT_TRUE(mapped.HasFailed());
+   EXPECT_TRUE(mapped.result.Empty());
+   EXPECT_EQ(nullptr, mapped.result.Data());
+}
+
+TEST_F(TestFileIO, ReadFileContentInto__ReusedBufferDoesNotAllocate) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+   const std::string content(1024, 'x');
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(filename, content).HasFailed());
+
+   std::vector<uint8_t> binaryBuffer;
+   std::string asciiBuffer;
+   EXPECT_FALSE(FileIO::ReadBinaryFileContentInto(filename, binaryBuffer).HasFailed());
+   EXPECT_FALSE(FileIO::ReadAsciiFileContentInto(filename, asciiBuffer).HasFailed());
+
+   const size_t allocationsBefore = gHeapAllocations.load();
+   for (size_t count = 0; count < 10; ++count) {
+      EXPECT_FALSE(FileIO::ReadBinaryFileContentInto(filename, binaryBuffer).HasFailed());
+      EXPECT_FALSE(FileIO::ReadAsciiFileContentInto(filename, asciiBuffer).HasFailed());
+   }
+   EXPECT_EQ(gHeapAllocations.load(), allocationsBefore);
+   EXPECT_EQ(content, asciiBuffer);
+   EXPECT_EQ(content.size(), binaryBuffer.size());
+
+   auto failed = FileIO::ReadAsciiFileContentInto({"/xyz/*&%/x.y.z"}, asciiBuffer);
+   EXPECT_TRUE(failed.HasFailed());
+   EXPECT_TRUE(asciiBuffer.empty());
+}
+
+TEST_F(TestFileIO, FileChunkReader__ReadsAllChunks) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+   std::string content;
+   for (size_t index = 0; index < 10000; ++index) {
+      content.push_back(static_cast<char>('a' + index % 26));
+   }
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(filename, content).HasFailed());
+
+   FileIO::FileChunkReader reader(filename, 4096);
+   ASSERT_FALSE(reader.Valid().HasFailed()) << reader.Valid().error;
+
+   std::vector<size_t> chunkSizes;
+   std::string readContent;
+   auto result = reader.Action([&](const uint8_t* chunk, size_t size) {
+      chunkSizes.push_back(size);
+      readContent.append(reinterpret_cast<const char*>(chunk), size);
+      return 0;
+   });
+   EXPECT_FALSE(result.HasFailed()) << result.error;
+   EXPECT_EQ(result.result, content.size());
+   EXPECT_EQ(readContent, content);
+   ASSERT_EQ(chunkSizes.size(), 3);
+   EXPECT_EQ(chunkSizes[0], 4096);
+   EXPECT_EQ(chunkSizes[1], 4096);
+   EXPECT_EQ(chunkSizes[2], 10000 - 2 * 4096);
+
+   // pull style after a reset, the handler can also stop the reading early
+   reader.Reset();
+   auto chunk = reader.Next();
+   EXPECT_EQ(chunk.result, 4096);
+   EXPECT_EQ(0, memcmp(reader.Data(), content.data(), chunk.result));
+   size_t calls = 0;
+   auto stopped = reader.Action([&](const uint8_t*, size_t) { ++calls; return 1; });
+   EXPECT_EQ(calls, 1);
+   EXPECT_EQ(stopped.result, 4096);
+}
+
+TEST_F(TestFileIO, FileChunkReader__StopsWhenInterrupted) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(filename, std::string(8192, 'x')).HasFailed());
+
+   FileIO::FileChunkReader reader(filename, 4096);
+   volatile int interrupted = 1;
+   FileIO::SetInterruptFlag(&interrupted);
+   auto result = reader.Action([](const uint8_t*, size_t) { return 0; });
+   FileIO::SetInterruptFlag(); // reset before we can exit the test
+   EXPECT_TRUE(result.HasFailed());
+   EXPECT_EQ(result.result, 0);
+}
+
+TEST_F(TestFileIO, FileChunkReader__CannotOpenFile) {
+   FileIO::FileChunkReader reader(std::string{"/xyz/*&%/x.y.z"});
+   EXPECT_TRUE(reader.Valid().HasFailed());
+   EXPECT_TRUE(reader.Next().HasFailed());
+}
+
+TEST_F(TestFileIO, BinaryAppender__CoalescesAppendsUntilFlush) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+
+   FileIO::AppenderOptions options;
+   options.flushBytes = 1000;
+   options.flushInterval = std::chrono::milliseconds{0};
+   std::vector<uint8_t> expected;
+   {
+      FileIO::BinaryAppender appender(filename, options);
+      ASSERT_FALSE(appender.Valid().HasFailed()) << appender.Valid().error;
+
+      const std::vector<uint8_t> record(100, 0xab);
+      for (size_t count = 0; count < 10; ++count) {
+         EXPECT_FALSE(appender.Append(record).HasFailed());
+         expected.insert(expected.end(), record.begin(), record.end());
+      }
+      EXPECT_EQ(appender.BufferedBytes(), 1000);
+      EXPECT_TRUE(FileIO::ReadBinaryFileContent(filename).result.empty()); // nothing written yet
+
+      // exceeding the threshold writes the buffer and the new record
+      const std::vector<uint8_t> trigger{0xde, 0xad, 0xbe, 0xef};
+      EXPECT_FALSE(appender.Append(trigger).HasFailed());
+      expected.insert(expected.end(), trigger.begin(), trigger.end());
+      EXPECT_EQ(appender.BufferedBytes(), 0);
+      EXPECT_EQ(FileIO::ReadBinaryFileContent(filename).result, expected);
+
+      EXPECT_FALSE(appender.Append(trigger).HasFailed());
+      expected.insert(expected.end(), trigger.begin(), trigger.end());
+      EXPECT_EQ(appender.BufferedBytes(), trigger.size());
+   } // flushed at scope exit
+   EXPECT_EQ(FileIO::ReadBinaryFileContent(filename).result, expected);
+}
+
+TEST_F(TestFileIO, BinaryAppender__FlushAndSyncPolicies) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+
+   for (auto policy : {FileIO::SyncPolicy::Never, FileIO::SyncPolicy::EveryNBytes, FileIO::SyncPolicy::EveryFlush}) {
+      FileIO::AppenderOptions options;
+      options.syncPolicy = policy;
+      options.syncBytes = 2;
+      FileIO::BinaryAppender appender(filename, options);
+      EXPECT_FALSE(appender.Append({1, 2, 3}).HasFailed());
+      EXPECT_FALSE(appender.Flush().HasFailed());
+      EXPECT_EQ(appender.BufferedBytes(), 0);
+   }
+   EXPECT_EQ(FileIO::ReadBinaryFileContent(filename).result.size(), 9);
+
+   FileIO::BinaryAppender invalid(std::string{"/xyz/*&%/x.y.z"});
+   EXPECT_TRUE(invalid.Valid().HasFailed());
+   EXPECT_TRUE(invalid.Append({1, 2, 3}).HasFailed());
+}
+
+TEST_F(TestFileIO, WriteGather__WritesAllBuffersInOrder) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+
+   std::string header{"header|"};
+   std::string body{"body|"};
+   std::string trailer{"trailer"};
+   struct iovec pieces[] = {{&header[0], header.size()}, {&body[0], body.size()}, {&trailer[0], trailer.size()}};
+   EXPECT_FALSE(FileIO::WriteGather(filename, pieces, 3).HasFailed());
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(filename).result, "header|body|trailer");
+
+   EXPECT_FALSE(FileIO::AppendGather(filename, pieces, 2).HasFailed());
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(filename).result, "header|body|trailerheader|body|");
+
+   // more buffers than a single writev accepts
+   std::string letter{"x"};
+   std::vector<struct iovec> many(IOV_MAX * 2 + 3, {&letter[0], letter.size()});
+   EXPECT_FALSE(FileIO::WriteGather(filename, many.data(), many.size()).HasFailed());
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(filename).result, std::string(many.size(), 'x'));
+
+   EXPECT_TRUE(FileIO::WriteGather({"/xyz/*&%/x.y.z"}, pieces, 3).HasFailed());
+}
+
 TEST_F(TestFileIO, CannotOpenBinaryFileToRead) {
    auto fileRead = FileIO::ReadBinaryFileContent({"/xyz/*&%/x.y.z"});
    EXPECT_TRUE(fileRead.result.empty());
@@ -179,6 +407,38 @@ TEST_F(TestFileIO, CanWriteToFileAndReadTheFile) {
    EXPECT_FALSE(fileRead.HasFailed());
 }
 
+TEST_F(TestFileIO, WriteFileAtomically__ReplacesContentAndKeepsPermissions) {
+   std::string filename{mTestDirectory + "/TestFileIO"};
+   ScopedFileCleanup cleanup{filename};
+
+   for (auto durability : {FileIO::Durability::None, FileIO::Durability::DataSync, FileIO::Durability::FullSync}) {
+      EXPECT_FALSE(FileIO::WriteFileAtomically(filename, "Hello World", durability).HasFailed());
+      EXPECT_EQ("Hello World", FileIO::ReadAsciiFileContent(filename).result);
+   }
+
+   ASSERT_EQ(0, chmod(filename.c_str(), 0600));
+   EXPECT_FALSE(FileIO::WriteFileAtomically(filename, "Replaced").HasFailed());
+   EXPECT_EQ("Replaced", FileIO::ReadAsciiFileContent(filename).result);
+   struct stat fileStat;
+   stat(filename.c_str(), &fileStat);
+   EXPECT_EQ(fileStat.st_mode & 0777, 0600);
+
+   // a new file gets the permissions that the umask allows
+   ASSERT_EQ(0, unlink(filename.c_str()));
+   const mode_t previousUmask = umask(027);
+   EXPECT_FALSE(FileIO::WriteFileAtomically(filename, "New").HasFailed());
+   umask(previousUmask);
+   stat(filename.c_str(), &fileStat);
+   EXPECT_EQ(fileStat.st_mode & 0777, 0640);
+
+   // no temporary files are left behind
+   auto contents = FileIO::GetDirectoryContents(mTestDirectory);
+   ASSERT_EQ(contents.result.size(), 1);
+   EXPECT_EQ(contents.result[0], "TestFileIO");
+
+   EXPECT_TRUE(FileIO::WriteFileAtomically({"/xyz/123/proc/stat"}, "Hello World").HasFailed());
+}
+
 TEST_F(TestFileIO, FileIsNotADirectory) {
    std::string filename{"/tmp/123_456_789"};
    {
@@ -322,6 +582,269 @@ TEST_F(TestFileIO, MoveFiles__FileCanBeMovedAcrossDirectories) {
 
 
 
+TEST_F(TestFileIO, CopyFile__SparseFileStaysSparse) {
+   std::string source{mTestDirectory + "/sparse_source"};
+   std::string dest{mTestDirectory + "/sparse_dest"};
+   const off_t kSize = 64 * 1024 * 1024;
+   const std::string data(4096, 'x');
+   {
+      FileIO::ScopedFileDescriptor file(source, O_WRONLY | O_CREAT, 0640);
+      ASSERT_NE(-1, file.fd);
+      ASSERT_EQ(0, ftruncate(file.fd, kSize));
+      ASSERT_EQ(data.size(), pwrite(file.fd, data.data(), data.size(), 0));
+      ASSERT_EQ(data.size(), pwrite(file.fd, data.data(), data.size(), kSize / 2));
+   }
+
+   for (bool allowReflink : {true, false}) {
+      FileIO::CopyOptions options;
+      options.allowReflink = allowReflink;
+      auto copied = FileIO::CopyFile(source, dest, options);
+      ASSERT_FALSE(copied.HasFailed()) << copied.error;
+      if (0 == copied.result.reflinkBytes) {
+         EXPECT_EQ(copied.result.CopiedBytes() + copied.result.holeBytes, kSize);
+         EXPECT_LT(copied.result.CopiedBytes(), kSize); // the holes were skipped
+      }
+
+      struct stat destStat;
+      ASSERT_EQ(0, stat(dest.c_str(), &destStat));
+      EXPECT_EQ(destStat.st_size, kSize);
+      EXPECT_EQ(destStat.st_mode & 0777, 0640);
+      EXPECT_LT(destStat.st_blocks * 512, kSize); // still sparse
+      EXPECT_EQ(FileIO::ReadBinaryFileContent(source).result, FileIO::ReadBinaryFileContent(dest).result);
+   }
+
+   EXPECT_TRUE(FileIO::CopyFile(source, source).HasFailed());
+   EXPECT_TRUE(FileIO::CopyFile(mTestDirectory + "/does_not_exist", dest).HasFailed());
+}
+
+TEST_F(TestFileIO, CopyFile__WithoutSparseDetection) {
+   std::string source{mTestDirectory + "/source"};
+   std::string dest{mTestDirectory + "/dest"};
+   std::string content(3 * 1024 * 1024 + 17, 'y');
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(source, content).HasFailed());
+
+   FileIO::CopyOptions options;
+   options.allowReflink = false;
+   options.preserveSparse = false;
+   auto copied = FileIO::CopyFile(source, dest, options);
+   ASSERT_FALSE(copied.HasFailed()) << copied.error;
+   EXPECT_EQ(copied.result.CopiedBytes(), content.size());
+   EXPECT_EQ(copied.result.holeBytes, 0);
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(dest).result, content);
+}
+
+TEST_F(TestFileIO, CopyFile__ProgressIsReported) {
+   std::string source{mTestDirectory + "/source"};
+   std::string dest{mTestDirectory + "/dest"};
+   std::string content(10 * 1024 * 1024 + 17, 'p');
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(source, content).HasFailed());
+
+   std::vector<FileIO::CopyProgress> reports;
+   FileIO::CopyOptions options;
+   options.allowReflink = false;
+   options.progressBytes = 1024 * 1024;
+   options.progressHandler = [&](FileIO::CopyProgress& progress) {
+      reports.push_back(progress);
+      return 0;
+   };
+   auto copied = FileIO::CopyFile(source, dest, options);
+   ASSERT_FALSE(copied.HasFailed()) << copied.error;
+
+   ASSERT_EQ(reports.size(), 11);
+   for (size_t index = 1; index < reports.size(); ++index) {
+      EXPECT_GT(reports[index].bytesDone, reports[index - 1].bytesDone);
+   }
+   EXPECT_EQ(reports.back().bytesDone, content.size());
+   EXPECT_EQ(reports.back().totalBytes, content.size());
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(dest).result, content);
+}
+
+TEST_F(TestFileIO, CopyFile__ProgressHandlerCanCancel) {
+   std::string source{mTestDirectory + "/source"};
+   std::string dest{mTestDirectory + "/dest"};
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(source, std::string(10 * 1024 * 1024, 'c')).HasFailed());
+
+   size_t calls = 0;
+   FileIO::CopyOptions options;
+   options.allowReflink = false;
+   options.progressBytes = 1024 * 1024;
+   options.progressHandler = [&](FileIO::CopyProgress&) {
+      return (++calls == 3) ? 1 : 0;
+   };
+   auto copied = FileIO::CopyFile(source, dest, options);
+   EXPECT_TRUE(copied.HasFailed());
+   EXPECT_EQ(errno, ECANCELED);
+   EXPECT_EQ(calls, 3);
+   EXPECT_EQ(copied.result.CopiedBytes(), 3 * 1024 * 1024);
+   EXPECT_FALSE(FileIO::DoesFileExist(dest)) << "a partial copy is removed";
+}
+
+TEST_F(TestFileIO, CopyFile__EachEngineCopiesAndDetectsTruncation) {
+   std::string source{mTestDirectory + "/source"};
+   std::string dest{mTestDirectory + "/dest"};
+   const size_t kSize = 4 * 1024 * 1024 + 17;
+   std::string content(kSize, 'e');
+   for (size_t index = 0; index < kSize; index += 4096) {
+      content[index] = static_cast<char> ('a' + index / 4096 % 26);
+   }
+
+   for (int engine = 0; engine < 3; ++engine) {
+      ASSERT_FALSE(FileIO::WriteAsciiFileContent(source, content).HasFailed());
+      FileIO::CopyOptions options;
+      options.allowReflink = false;
+      options.allowCopyFileRange = (0 == engine);
+      options.allowSendfile = (1 == engine);
+      auto copied = FileIO::CopyFile(source, dest, options);
+      ASSERT_FALSE(copied.HasFailed()) << copied.error;
+      EXPECT_EQ(FileIO::ReadAsciiFileContent(dest).result, content) << engine;
+      EXPECT_EQ(copied.result.sendfileBytes, (1 == engine) ? kSize : 0) << engine;
+      EXPECT_EQ(copied.result.bufferedBytes, (2 == engine) ? kSize : 0) << engine;
+
+      // the source shrinks after the first megabyte, the copy must fail instead of padding with zeros
+      options.progressBytes = 1024 * 1024;
+      options.progressHandler = [&](FileIO::CopyProgress&) {
+         return truncate(source.c_str(), 1024 * 1024);
+      };
+      auto truncated = FileIO::CopyFile(source, dest, options);
+      EXPECT_TRUE(truncated.HasFailed()) << engine;
+      EXPECT_EQ(errno, ENODATA) << engine;
+      EXPECT_FALSE(FileIO::DoesFileExist(dest)) << engine;
+   }
+}
+
+TEST_F(TestFileIO, CopyFile__ThrottledCopy) {
+   std::string source{mTestDirectory + "/source"};
+   std::string dest{mTestDirectory + "/dest"};
+   const size_t kSize = 2 * 1024 * 1024;
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(source, std::string(kSize, 't')).HasFailed());
+
+   FileIO::CopyOptions options;
+   options.allowReflink = false;
+   options.maxBytesPerSecond = 8 * 1024 * 1024; // at least 250ms for the copy
+   StopWatch timer;
+   auto copied = FileIO::CopyFile(source, dest, options);
+   auto elapsedMs = timer.ElapsedMs();
+   ASSERT_FALSE(copied.HasFailed()) << copied.error;
+   EXPECT_GE(elapsedMs, 200);
+
+   // the handler lifts the throttle at the first report
+   options.progressBytes = 256 * 1024;
+   options.maxBytesPerSecond = 1024 * 1024; // two seconds if it was kept
+   options.progressHandler = [](FileIO::CopyProgress& progress) {
+      progress.maxBytesPerSecond = 0;
+      return 0;
+   };
+   timer.Restart();
+   auto unthrottled = FileIO::CopyFile(source, dest, options);
+   elapsedMs = timer.ElapsedMs();
+   ASSERT_FALSE(unthrottled.HasFailed()) << unthrottled.error;
+   EXPECT_LT(elapsedMs, 1500);
+   EXPECT_EQ(FileIO::ReadBinaryFileContent(dest).result.size(), kSize);
+}
+
+TEST_F(TestFileIO, MoveFileWithProgress__AcrossDevices) {
+   const std::string otherDevice{"/dev/shm"};
+   struct stat stat_path1;
+   struct stat stat_path2;
+   if (0 != stat(otherDevice.c_str(), &stat_path1) || 0 != stat(mTestDirectory.c_str(), &stat_path2) || stat_path1.st_dev == stat_path2.st_dev) {
+      SUCCEED() << "Skipping test. Cannot run test. No separate device at: " << otherDevice;
+      return;
+   }
+
+   const std::string from{otherDevice + "/FileIO_MoveFileWithProgress"};
+   const std::string to{mTestDirectory + "/moved"};
+   const std::string content(3 * 1024 * 1024, 'm');
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(from, content).HasFailed());
+
+   size_t lastBytesDone = 0;
+   FileIO::CopyOptions options;
+   options.progressBytes = 1024 * 1024;
+   options.progressHandler = [&](FileIO::CopyProgress& progress) {
+      lastBytesDone = progress.bytesDone;
+      return 0;
+   };
+   EXPECT_TRUE(FileIO::MoveFileWithProgress(from, to, options));
+   EXPECT_EQ(lastBytesDone, content.size());
+   EXPECT_FALSE(FileIO::DoesFileExist(from));
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(to).result, content);
+}
+
+TEST_F(TestFileIO, MoveFiles__BatchReportsEachFile) {
+   auto dir1 = CreateSubDirectory("some_directory1");
+   auto dir2 = CreateSubDirectory("some_directory2");
+
+   std::vector<std::pair<std::string, std::string>> moves;
+   for (size_t index = 0; index < 100; ++index) {
+      CreateFile(dir1, std::to_string(index));
+      moves.emplace_back(dir1 + "/" + std::to_string(index), dir2 + "/" + std::to_string(index));
+   }
+   moves.emplace_back(dir1 + "/bogus", dir2 + "/bogus");
+
+   auto results = FileIO::MoveFiles(moves);
+   ASSERT_EQ(results.size(), moves.size());
+   for (size_t index = 0; index < 100; ++index) {
+      EXPECT_FALSE(results[index].HasFailed()) << results[index].error;
+      EXPECT_FALSE(FileIO::DoesFileExist(moves[index].first));
+      EXPECT_TRUE(FileIO::DoesFileExist(moves[index].second));
+   }
+   EXPECT_TRUE(results.back().HasFailed());
+   EXPECT_FALSE(results.back().result);
+}
+
+TEST_F(TestFileIO, MoveFileWithProgress__CancelledMoveLeavesNoDestination) {
+   const std::string otherDevice{"/dev/shm"};
+   struct stat stat_path1;
+   struct stat stat_path2;
+   if (0 != stat(otherDevice.c_str(), &stat_path1) || 0 != stat(mTestDirectory.c_str(), &stat_path2) || stat_path1.st_dev == stat_path2.st_dev) {
+      SUCCEED() << "Skipping test. Cannot run test. No separate device at: " << otherDevice;
+      return;
+   }
+
+   const std::string from{otherDevice + "/FileIO_CancelledMove_" + std::to_string(getpid())};
+   ScopedFileCleanup cleanup{from};
+   const std::string to{mTestDirectory + "/moved"};
+   const std::string content(4 * 1024 * 1024, 'c');
+   ASSERT_FALSE(FileIO::WriteAsciiFileContent(from, content).HasFailed());
+
+   size_t calls = 0;
+   FileIO::CopyOptions options;
+   options.progressBytes = 1024 * 1024;
+   options.progressHandler = [&](FileIO::CopyProgress&) {
+      return (++calls == 2) ? 1 : 0;
+   };
+   EXPECT_FALSE(FileIO::MoveFileWithProgress(from, to, options));
+   EXPECT_EQ(calls, 2);
+   EXPECT_FALSE(FileIO::DoesFileExist(to)) << "the partial copy is removed";
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(from).result, content);
+}
+
+TEST_F(TestFileIO, MoveFiles__AcrossDevices) {
+   const std::string otherDevice{"/dev/shm"};
+   struct stat stat_path1;
+   struct stat stat_path2;
+   if (0 != stat(otherDevice.c_str(), &stat_path1) || 0 != stat(mTestDirectory.c_str(), &stat_path2) || stat_path1.st_dev == stat_path2.st_dev) {
+      SUCCEED() << "Skipping test. Cannot run test. No separate device at: " << otherDevice;
+      return;
+   }
+
+   std::vector<std::pair<std::string, std::string>> moves;
+   for (size_t index = 0; index < 20; ++index) {
+      const std::string from{otherDevice + "/FileIO_MoveFiles_" + std::to_string(index)};
+      EXPECT_FALSE(FileIO::WriteAsciiFileContent(from, std::string(index * 1000, 'z')).HasFailed());
+      moves.emplace_back(from, mTestDirectory + "/moved_" + std::to_string(index));
+   }
+
+   FileIO::MoveOptions options;
+   options.threads = 3;
+   auto results = FileIO::MoveFiles(moves, options);
+   ASSERT_EQ(results.size(), moves.size());
+   for (size_t index = 0; index < moves.size(); ++index) {
+      EXPECT_FALSE(results[index].HasFailed()) << results[index].error;
+      EXPECT_FALSE(FileIO::DoesFileExist(moves[index].first));
+      EXPECT_EQ(FileIO::ReadAsciiFileContent(moves[index].second).result, std::string(index * 1000, 'z'));
+   }
+}
+
 TEST_F(TestFileIO, SYSTEM__MoveFiles__ThreadSafeMoveOfFilesShouldBeRunAsRoot) {
    std::string oldStorage = "/tmp";
    std::string newStorage = GetCurrentDirectory();
@@ -618,6 +1141,117 @@ TEST_F(TestFileIO, CleanDirectoryOfFilesAndDirectories) {
 
 }
 
+TEST_F(TestFileIO, CleanDirectory__SymbolicLinksAreNotFollowed) {
+   const std::string baseDir = CreateSubDirectory("base");
+   const std::string outside = CreateSubDirectory("outside");
+   const std::string outsideFile = CreateFile(outside, "keep.txt");
+   CreateFile(CreateSubDirectory("dir", baseDir), "file.txt");
+   ASSERT_EQ(0, symlink(outside.c_str(), std::string{baseDir + "/link"}.c_str()));
+
+   size_t removedFiles{0};
+   auto result = FileIO::CleanDirectory(baseDir, false, removedFiles);
+   EXPECT_FALSE(result.HasFailed()) << result.error;
+   EXPECT_EQ(removedFiles, 1);
+   EXPECT_FALSE(FileIO::DoesDirectoryExist(baseDir + "/dir"));
+   EXPECT_TRUE(FileIO::DoesFileExist(outsideFile));
+}
+
+TEST_F(TestFileIO, CleanDirectory__InParallel) {
+   const std::string baseDir = CreateSubDirectory("base");
+   auto createContent = [&]() {
+      // wide and deep: 8 subtrees that are 10 levels deep, with files on every level
+      size_t files = 0;
+      for (size_t branch = 0; branch < 8; ++branch) {
+         std::string currentLevel = baseDir;
+         for (size_t depth = 0; depth < 10; ++depth) {
+            currentLevel = CreateSubDirectory("dir" + std::to_string(branch), currentLevel);
+            CreateSubDirectory("empty", currentLevel);
+            CreateFile(currentLevel, "file1.txt");
+            CreateFile(currentLevel, "file2.txt");
+            files += 2;
+         }
+      }
+      CreateFile(baseDir, "top.txt");
+      return files + 1;
+   };
+
+   size_t expectedFiles = createContent();
+   size_t removedFiles{0};
+   auto kept = FileIO::CleanDirectory(baseDir, false, removedFiles, 4);
+   EXPECT_FALSE(kept.HasFailed()) << kept.error;
+   EXPECT_EQ(removedFiles, expectedFiles);
+   EXPECT_TRUE(FileIO::DoesDirectoryExist(baseDir));
+   EXPECT_FALSE(FileIO::DoesDirectoryHaveContent(baseDir));
+
+   expectedFiles = createContent();
+   auto removed = FileIO::CleanDirectory(baseDir, true, removedFiles, 4);
+   EXPECT_FALSE(removed.HasFailed()) << removed.error;
+   EXPECT_EQ(removedFiles, expectedFiles);
+   EXPECT_FALSE(FileIO::DoesDirectoryExist(baseDir));
+
+   // the serial version counts the files of the whole tree too
+   CreateSubDirectory("base");
+   expectedFiles = createContent();
+   EXPECT_FALSE(FileIO::CleanDirectory(baseDir, true, removedFiles).HasFailed());
+   EXPECT_EQ(removedFiles, expectedFiles);
+
+   EXPECT_TRUE(FileIO::CleanDirectory("/", false, removedFiles, 4).HasFailed());
+   EXPECT_TRUE(FileIO::CleanDirectory("/root", false, removedFiles, 4).HasFailed());
+   EXPECT_TRUE(FileIO::CleanDirectory("/bla/bla/does/not/exist", false, removedFiles, 4).HasFailed());
+}
+
+TEST_F(TestFileIO, CleanDirectory__InParallelDirectoriesReplacedBySymbolicLinksAreNotFollowed) {
+   const std::string baseDir = CreateSubDirectory("base");
+   const std::string outside = CreateSubDirectory("outside");
+   const std::string outsideFile = CreateFile(outside, "keep.txt");
+   ASSERT_EQ(0, symlink(outside.c_str(), std::string{baseDir + "/link"}.c_str()));
+   const size_t directories = 200;
+   for (size_t index = 0; index < directories; ++index) {
+      CreateFile(CreateSubDirectory("dir" + std::to_string(index), baseDir), "file.txt");
+   }
+
+   // swap the directories for links to the outside while they are being cleaned
+   std::thread swapper([&] {
+      for (size_t index = 0; index < directories; ++index) {
+         const std::string directory = baseDir + "/dir" + std::to_string(index);
+         if (0 == rename(directory.c_str(), std::string{baseDir + "/aside" + std::to_string(index)}.c_str())) {
+            symlink(outside.c_str(), directory.c_str());
+         }
+      }
+   });
+   size_t removedFiles{0};
+   FileIO::CleanDirectory(baseDir, false, removedFiles, 4);
+   swapper.join();
+
+   EXPECT_TRUE(FileIO::DoesFileExist(outsideFile));
+   EXPECT_TRUE(FileIO::DoesDirectoryExist(outside));
+
+   // what is left is links and directories that were moved aside, none of them are followed
+   auto cleaned = FileIO::CleanDirectory(baseDir, false, removedFiles, 4);
+   EXPECT_FALSE(cleaned.HasFailed()) << cleaned.error;
+   EXPECT_TRUE(FileIO::DoesFileExist(outsideFile));
+}
+
+TEST_F(TestFileIO, WorkStealingPool__TasksCanSubmitTasks) {
+   std::atomic<size_t> visited{0};
+   FileIO::WorkStealingPool pool(4);
+   // a binary tree of tasks, 2^12 - 1 of them
+   std::function<void(size_t)> visit = [&](size_t depth) {
+      ++visited;
+      if (depth < 11) {
+         pool.Submit([&visit, depth] { visit(depth + 1); });
+         pool.Submit([&visit, depth] { visit(depth + 1); });
+      }
+   };
+   pool.Submit([&visit] { visit(0); });
+   pool.Wait();
+   EXPECT_EQ(visited, 4095);
+
+   pool.Submit([&visited] { visited = 0; });
+   pool.Wait();
+   EXPECT_EQ(visited, 0);
+}
+
 TEST_F(TestFileIO, TestSudoFileReadAsciiFileContent) {
 
    int previousUID = setfsuid(-1);
@@ -706,6 +1340,76 @@ TEST_F(TestFileIO, AThousandFiles) {
 }
 
 
+TEST_F(TestFileIO, DirectoryReader_EntryViews__SmallBufferAndNoAllocations) {
+   using namespace FileIO;
+   for (size_t index = 0; index < 1000; ++index) {
+      CreateFile(mTestDirectory, std::to_string(index));
+   }
+   CreateSubDirectory("some_directory");
+
+   // a small buffer forces many getdents64 calls
+   DirectoryReader reader(mTestDirectory, 1024);
+   ASSERT_FALSE(reader.Valid().HasFailed()) << reader.Valid().error;
+
+   size_t files = 0;
+   size_t directories = 0;
+   size_t nameBytes = 0;
+   DirectoryEntryView entry;
+   const size_t allocationsBefore = gHeapAllocations.load();
+   while (reader.Next(entry)) {
+      EXPECT_NE(entry.inode, 0);
+      EXPECT_EQ(entry.nameLength, strlen(entry.name));
+      nameBytes += entry.nameLength;
+      files += (DT_REG == entry.type) ? 1 : 0;
+      directories += (DT_DIR == entry.type) ? 1 : 0;
+   }
+   EXPECT_EQ(gHeapAllocations.load(), allocationsBefore);
+   EXPECT_EQ(files, 1000);
+   EXPECT_EQ(directories, 1);
+   EXPECT_EQ(nameBytes, 2890 + std::string{"some_directory"}.size()); // 10*1 + 90*2 + 900*3
+
+   reader.Reset();
+   ASSERT_TRUE(reader.Next(entry));
+   struct stat info;
+   ASSERT_EQ(0, stat(std::string{mTestDirectory + "/" + entry.name}.c_str(), &info));
+   EXPECT_EQ(info.st_ino, entry.inode);
+}
+
+TEST_F(TestFileIO, DirectoryReader_DirectoryEntry__AllTypesAndInodes) {
+   using namespace FileIO;
+   CreateFile(mTestDirectory, "file");
+   CreateSubDirectory("directory");
+   ASSERT_EQ(0, symlink("file", std::string{mTestDirectory + "/link"}.c_str()));
+   ASSERT_EQ(0, mkfifo(std::string{mTestDirectory + "/fifo"}.c_str(), 0600));
+   const std::map<std::string, EntryType> expected = {
+      {"file", EntryType::File}, {"directory", EntryType::Directory},
+      {"link", EntryType::SymbolicLink}, {"fifo", EntryType::Fifo}};
+
+   for (bool resolveUnknownTypes : {false, true}) {
+      DirectoryReader reader(mTestDirectory, DirectoryReader::kDefaultBufferSize, resolveUnknownTypes);
+      std::map<std::string, EntryType> found;
+      DirectoryEntry entry;
+      while (reader.Next(entry)) {
+         found[entry.name] = entry.type;
+         struct stat info;
+         ASSERT_EQ(0, lstat(std::string{mTestDirectory + "/" + entry.name}.c_str(), &info));
+         EXPECT_EQ(info.st_ino, entry.inode) << entry.name;
+      }
+      EXPECT_EQ(found, expected);
+   }
+
+   // the original interface still reports only files and directories by name
+   DirectoryReader reader(mTestDirectory);
+   size_t unknown = 0;
+   for (auto next = reader.Next(); next.first != FileType::End; next = reader.Next()) {
+      if (FileType::Unknown == next.first) {
+         ++unknown;
+         EXPECT_EQ(next.second, "");
+      }
+   }
+   EXPECT_EQ(unknown, 2);
+}
+
 TEST_F(TestFileIO, DirectoryReader_NotExistingDirectory) {
    FileIO::DirectoryReader reader{mTestDirectory + "/_#Does_not+_exist"};
    EXPECT_TRUE(reader.Valid().HasFailed()) << reader.Valid().error;
@@ -943,6 +1647,180 @@ TEST_F(TestFileIO, DISABLED_System_Performance_FileIO_DirectoryReader__vs_Boost_
        << timeCheck << " millisec" << std::endl;
 }
 
+// Listing 1,000,000 entries: readdir64 + std::string per entry vs getdents64 entry views
+TEST_F(TestFileIO, DISABLED_System_Performance_DirectoryReader__readdir_vs_getdents64) {
+   const std::string directory{mTestDirectory + "/million"};
+   CreateSubDirectory("million");
+   const size_t kEntries = 1000000;
+   for (size_t index = 0; index < kEntries; ++index) {
+      // spool like names, too long for the small string optimization
+      FileIO::ScopedFileDescriptor created(directory + "/spool_entry_" + std::to_string(index), O_WRONLY | O_CREAT, 0644);
+   }
+
+   StopWatch timer;
+   size_t found = 0;
+   size_t allocationsBefore = gHeapAllocations.load();
+   DIR* dir = opendir(directory.c_str());
+   while (struct dirent64* entry = readdir64(dir)) {
+      std::string name{entry->d_name};
+      found += (DT_REG == entry->d_type) ? 1 : 0;
+   }
+   closedir(dir);
+   std::cout << "readdir64 + std::string:          " << found << " entries in " << timer.ElapsedMs()
+             << " ms, " << (gHeapAllocations.load() - allocationsBefore) << " allocations" << std::endl;
+
+   for (size_t bufferSize : {size_t{32 * 1024}, size_t{256 * 1024}}) {
+      timer.Restart();
+      found = 0;
+      allocationsBefore = gHeapAllocations.load();
+      FileIO::DirectoryReader reader(directory, bufferSize);
+      FileIO::DirectoryEntryView entry;
+      while (reader.Next(entry)) {
+         found += (DT_REG == entry.type) ? 1 : 0;
+      }
+      std::cout << "DirectoryReader " << bufferSize / 1024 << "KB buffer:       " << found << " entries in "
+                << timer.ElapsedMs() << " ms, " << (gHeapAllocations.load() - allocationsBefore) << " allocations" << std::endl;
+   }
+   FileIO::CleanDirectory(directory, true);
+}
+
+namespace {
+   /// The ReadBinaryFileContent implementation before it was rewritten on open/fstat/read
+   std::vector<uint8_t> IfstreamReadBinaryFileContent(const std::string& pathToFile) {
+      std::ifstream in(pathToFile, std::ifstream::binary);
+      std::vector<char> contents;
+      in.seekg(0, std::ios::end);
+      auto end = in.tellg();
+      in.seekg(0, std::ios::beg);
+      contents.resize(end);
+      in.read(&contents[0], contents.size());
+      return {contents.begin(), contents.end()};
+   }
+
+   std::string IfstreamReadAsciiFileContent(const std::string& pathToFile) {
+      auto content = IfstreamReadBinaryFileContent(pathToFile);
+      return std::string(reinterpret_cast<const char*> (content.data()), content.size());
+   }
+
+   template<typename ReadFunction>
+   void BenchmarkRead(const std::string& name, const std::string& file, const size_t fileSize, ReadFunction readFunction) {
+      // at least 1GB and at least 10 calls in total, to smooth out the timer resolution
+      const size_t kTotalBytes = 1024UL * 1024UL * 1024UL;
+      const size_t calls = std::max(size_t{10}, kTotalBytes / fileSize);
+
+      readFunction(file); // warm up the page cache
+      const size_t allocationsBefore = gHeapAllocations.load();
+      StopWatch timer;
+      for (size_t call = 0; call < calls; ++call) {
+         readFunction(file);
+      }
+      auto elapsedMs = std::max(decltype(timer.ElapsedMs()){1}, timer.ElapsedMs());
+      const size_t allocations = gHeapAllocations.load() - allocationsBefore;
+      const double megabytesPerSecond = (double(fileSize) * calls / (1024.0 * 1024.0)) / (elapsedMs / 1000.0);
+
+      std::cout << name << " file size: " << fileSize << " bytes, " << megabytesPerSecond << " MB/s, "
+                << double(allocations) / calls << " allocations per call" << std::endl;
+   }
+} // anonymous namespace
+
+// Performance of ifstream (before) vs open/fstat/read (after) for file sizes 4KB -> 4GB
+// Requires ~4GB of space in /tmp and ~8GB of RAM for the largest file size
+TEST_F(TestFileIO, DISABLED_System_Performance_ReadFileContent__ifstream_vs_syscalls) {
+   const std::string file{mTestDirectory + "/read_benchmark"};
+   ScopedFileCleanup cleanup{file};
+
+   for (size_t kbytes = 4; kbytes <= 4UL * 1024UL * 1024UL; kbytes *= 16) {
+      std::string createFile = {"dd bs=1024 count=" + std::to_string(kbytes) + " if=/dev/urandom of=" + file + " > /dev/null 2>&1"};
+      ASSERT_EQ(0, system(createFile.c_str()));
+      const size_t fileSize = kbytes * 1024;
+
+      BenchmarkRead("before: ifstream binary  ", file, fileSize, IfstreamReadBinaryFileContent);
+      BenchmarkRead("after:  syscalls binary  ", file, fileSize, FileIO::ReadBinaryFileContent);
+      BenchmarkRead("before: ifstream ascii   ", file, fileSize, IfstreamReadAsciiFileContent);
+      BenchmarkRead("after:  syscalls ascii   ", file, fileSize, FileIO::ReadAsciiFileContent);
+   }
+}
+
+// 100 byte records, WriteAppendBinaryFileContent (open/write/close per record) vs BinaryAppender
+TEST_F(TestFileIO, DISABLED_System_Performance_AppendRecords__WriteAppendBinaryFileContent_vs_BinaryAppender) {
+   const std::string file{mTestDirectory + "/append_benchmark"};
+   const std::vector<uint8_t> record(100, 0xab);
+   const size_t kRecords = 1000000;
+   auto report = [&](const std::string& name, const long long elapsedMs) {
+      const double megabytes = double(kRecords * record.size()) / (1024.0 * 1024.0);
+      std::cout << name << kRecords << " records in " << elapsedMs << " ms, "
+                << megabytes / (std::max(elapsedMs, 1LL) / 1000.0) << " MB/s" << std::endl;
+   };
+
+   {
+      ScopedFileCleanup cleanup{file};
+      StopWatch timer;
+      for (size_t count = 0; count < kRecords; ++count) {
+         FileIO::WriteAppendBinaryFileContent(file, record);
+      }
+      report("WriteAppendBinaryFileContent: ", timer.ElapsedMs());
+   }
+   {
+      ScopedFileCleanup cleanup{file};
+      StopWatch timer;
+      {
+         FileIO::BinaryAppender appender(file);
+         for (size_t count = 0; count < kRecords; ++count) {
+            appender.Append(record);
+         }
+      }
+      report("BinaryAppender:               ", timer.ElapsedMs());
+   }
+}
+
+// Cost of replacing a 4KB state file at each durability level
+TEST_F(TestFileIO, DISABLED_System_Performance_WriteFileAtomically__DurabilityLevels) {
+   const std::string file{mTestDirectory + "/atomic_benchmark"};
+   ScopedFileCleanup cleanup{file};
+   const std::string content(4096, 'x');
+   const size_t kWrites = 1000;
+
+   StopWatch timer;
+   for (size_t count = 0; count < kWrites; ++count) {
+      FileIO::WriteAsciiFileContent(file, content);
+   }
+   std::cout << "WriteAsciiFileContent (in place):    " << timer.ElapsedMs() << " ms for " << kWrites << " writes" << std::endl;
+
+   const std::vector<std::pair<std::string, FileIO::Durability>> levels = {
+      {"WriteFileAtomically Durability::None:     ", FileIO::Durability::None},
+      {"WriteFileAtomically Durability::DataSync: ", FileIO::Durability::DataSync},
+      {"WriteFileAtomically Durability::FullSync: ", FileIO::Durability::FullSync}};
+   for (const auto& level : levels) {
+      timer.Restart();
+      for (size_t count = 0; count < kWrites; ++count) {
+         FileIO::WriteFileAtomically(file, content, level.second);
+      }
+      std::cout << level.first << timer.ElapsedMs() << " ms for " << kWrites << " writes" << std::endl;
+   }
+}
+
+// Purge of a spool like tree, 100 directories with 1000 files each, with 1 -> 16 threads
+TEST_F(TestFileIO, DISABLED_System_Performance_CleanDirectory__SerialVsParallel) {
+   const std::string baseDir{mTestDirectory + "/spool"};
+   for (size_t threads : {1, 2, 4, 8, 16}) {
+      CreateSubDirectory("spool");
+      for (size_t directory = 0; directory < 100; ++directory) {
+         const std::string subDirectory = CreateSubDirectory(std::to_string(directory), baseDir);
+         for (size_t file = 0; file < 1000; ++file) {
+            FileIO::ScopedFileDescriptor created(subDirectory + "/" + std::to_string(file), O_WRONLY | O_CREAT, 0644);
+         }
+      }
+
+      size_t removedFiles{0};
+      StopWatch timer;
+      auto result = FileIO::CleanDirectory(baseDir, true, removedFiles, threads);
+      auto elapsedMs = timer.ElapsedMs();
+      EXPECT_FALSE(result.HasFailed()) << result.error;
+      std::cout << "CleanDirectory with " << threads << " threads removed " << removedFiles
+                << " files in " << elapsedMs << " ms" << std::endl;
+   }
+}
+
 std::string TestFileIO::CreateTestDirectoryAndFiles(const std::vector<std::string>& filenamesToTouch, const std::string& newDirName = "TestDir") {
    // Create directory
    std::string newDirectoryPath = mTestDirectory + std::string("/") + newDirName;
@@ -1001,3 +1879,569 @@ TEST_F(TestFileIO, HiddenFilesAreReturned) {
    auto dirContentsResult = FileIO::GetDirectoryContents(createdDirectoryPath);
    VerifyDirectoryContents(filenames, dirContentsResult);
 }
+
+TEST_F(TestFileIO, ListDirectory__FiltersAndOrders) {
+   // c.log is the largest and the oldest, a.log the smallest and the newest
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/c.log", std::string(300, 'c')).HasFailed());
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/b.log", std::string(200, 'b')).HasFailed());
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/a.log", std::string(100, 'a')).HasFailed());
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/d.txt", "d").HasFailed());
+   CreateSubDirectory("e.log");
+   const struct timespec times[] = {{1000, 0}, {1000, 0}};
+   ASSERT_EQ(0, utimensat(AT_FDCWD, std::string{mTestDirectory + "/c.log"}.c_str(), times, 0));
+
+   auto Names = [](const Result<std::vector<FileIO::ListedEntry>>& listed) {
+      std::vector<std::string> names;
+      for (const auto& entry : listed.result) {
+         names.push_back(entry.name);
+      }
+      return names;
+   };
+   typedef std::vector<std::string> NameList;
+
+   FileIO::ListingOptions options;
+   EXPECT_EQ(Names(FileIO::ListDirectory(mTestDirectory, options)), (NameList{"a.log", "b.log", "c.log", "d.txt"}));
+
+   options.suffix = ".log";
+   EXPECT_EQ(Names(FileIO::ListDirectory(mTestDirectory, options)), (NameList{"a.log", "b.log", "c.log"}));
+
+   options.order = FileIO::ListingOrder::Size;
+   auto bySize = FileIO::ListDirectory(mTestDirectory, options);
+   EXPECT_EQ(Names(bySize), (NameList{"a.log", "b.log", "c.log"}));
+   EXPECT_EQ(bySize.result.back().size, 300);
+
+   options.order = FileIO::ListingOrder::ModificationTime;
+   EXPECT_EQ(Names(FileIO::ListDirectory(mTestDirectory, options)).front(), "c.log");
+
+   options.suffix.clear();
+   options.glob = "[ab]*";
+   options.order = FileIO::ListingOrder::Name;
+   EXPECT_EQ(Names(FileIO::ListDirectory(mTestDirectory, options)), (NameList{"a.log", "b.log"}));
+
+   options.glob.clear();
+   options.filesOnly = false;
+   options.predicate = [](const FileIO::DirectoryEntry& entry) {
+      return FileIO::EntryType::Directory == entry.type;
+   };
+   EXPECT_EQ(Names(FileIO::ListDirectory(mTestDirectory, options)), (NameList{"e.log"}));
+
+   FileIO::ListingOptions inodeOrder;
+   inodeOrder.order = FileIO::ListingOrder::Inode;
+   auto byInode = FileIO::ListDirectory(mTestDirectory, inodeOrder);
+   ASSERT_EQ(byInode.result.size(), 4);
+   EXPECT_TRUE(std::is_sorted(byInode.result.begin(), byInode.result.end(), [](const FileIO::ListedEntry& left, const FileIO::ListedEntry& right) {
+      return left.inode < right.inode;
+   }));
+   EXPECT_EQ(byInode.result.front().size, 0); // not stat'ed
+
+   EXPECT_TRUE(FileIO::ListDirectory(mTestDirectory + "/does_not_exist").HasFailed());
+}
+
+TEST_F(TestFileIO, GetDirectoryContentsInto__ReusedVectorDoesNotAllocate) {
+   std::vector<std::string> filenames = {"a_filename_longer_than_sso_1", "a_filename_longer_than_sso_2", "test3"};
+   auto createdDirectoryPath = CreateTestDirectoryAndFiles(filenames);
+
+   std::vector<std::string> contents;
+   EXPECT_TRUE(FileIO::GetDirectoryContentsInto(createdDirectoryPath, contents).HasSuccess());
+   VerifyDirectoryContents(filenames, Result<std::vector<std::string>>{contents});
+
+   const size_t allocationsBefore = gHeapAllocations.load();
+   EXPECT_TRUE(FileIO::GetDirectoryContentsInto(createdDirectoryPath, contents).HasSuccess());
+   EXPECT_EQ(gHeapAllocations.load(), allocationsBefore);
+   VerifyDirectoryContents(filenames, Result<std::vector<std::string>>{contents});
+
+   EXPECT_TRUE(FileIO::GetDirectoryContentsInto("directory/does/not/exist", contents).HasFailed());
+   EXPECT_TRUE(contents.empty());
+}
+
+TEST_F(TestFileIO, ReadFilesBatch__SameAsReadAsciiFileContent) {
+   std::vector<std::string> paths;
+   for (size_t index = 0; index < 20; ++index) {
+      paths.push_back(mTestDirectory + "/small_" + std::to_string(index));
+      EXPECT_FALSE(FileIO::WriteAsciiFileContent(paths.back(), std::string(index * 1000, 'a' + index)).HasFailed());
+   }
+   paths.push_back(mTestDirectory + "/does_not_exist");
+   paths.push_back(mTestDirectory);   // a directory: open works, read fails
+   paths.push_back("/proc/self/stat_does_not_exist");
+   paths.push_back("/proc/version"); // no size from stat, read until EOF
+
+   for (bool useIoUring : {true, false}) {
+      FileIO::BatchReadOptions options;
+      options.queueDepth = 4; // fewer than the files
+      options.useIoUring = useIoUring;
+      auto results = FileIO::ReadFilesBatch(paths, options);
+      ASSERT_EQ(results.size(), paths.size());
+      for (size_t index = 0; index < paths.size(); ++index) {
+         auto expected = FileIO::ReadAsciiFileContent(paths[index]);
+         EXPECT_EQ(results[index].result, expected.result) << paths[index];
+         EXPECT_EQ(results[index].error, expected.error) << paths[index];
+      }
+      EXPECT_TRUE(results[20].HasFailed());
+      EXPECT_TRUE(results[21].HasFailed());
+      EXPECT_FALSE(results[23].result.empty());
+   }
+   EXPECT_TRUE(FileIO::ReadFilesBatch({}).empty());
+}
+
+TEST_F(TestFileIO, AsyncFileIO__FuturesAndCallbacks) {
+   const std::string file{mTestDirectory + "/async.txt"};
+   auto written = FileIO::WriteAsciiFileContentAsync(file, "hello");
+   ASSERT_FALSE(written.get().HasFailed());
+   ASSERT_FALSE(FileIO::AppendWriteAsciiFileContentAsync(file, " world").get().HasFailed());
+   auto read = FileIO::ReadAsciiFileContentAsync(file).get();
+   EXPECT_FALSE(read.HasFailed());
+   EXPECT_EQ(read.result, "hello world");
+   EXPECT_EQ(FileIO::ReadBinaryFileContentAsync(file).get().result.size(), 11);
+
+   std::promise<std::string> calledBack;
+   std::thread::id caller = std::this_thread::get_id();
+   std::thread::id callbackThread;
+   FileIO::ReadAsciiFileContentAsync(file, [&](const Result<std::string>& result) {
+      callbackThread = std::this_thread::get_id();
+      calledBack.set_value(result.result);
+   });
+   EXPECT_EQ(calledBack.get_future().get(), "hello world");
+   EXPECT_NE(callbackThread, caller);
+
+   const std::string moved{mTestDirectory + "/moved.txt"};
+   EXPECT_FALSE(FileIO::MoveFileAsync(file, moved).get().HasFailed());
+   EXPECT_TRUE(FileIO::DoesFileExist(moved));
+   auto notMoved = FileIO::MoveFileAsync(file, moved).get();
+   EXPECT_TRUE(notMoved.HasFailed());
+   EXPECT_FALSE(notMoved.result);
+   EXPECT_FALSE(FileIO::RemoveFileAsync(moved).get().HasFailed());
+   EXPECT_TRUE(FileIO::ReadAsciiFileContentAsync(moved).get().HasFailed());
+}
+
+TEST_F(TestFileIO, IOExecutor__BoundedQueue) {
+   std::promise<void> release;
+   std::shared_future<void> released = release.get_future().share();
+   std::atomic<size_t> ran{0};
+   auto blocker = [&] {
+      released.wait();
+      ++ran;
+   };
+
+   {
+      FileIO::ExecutorOptions options;
+      options.threads = 1;
+      options.queueCapacity = 1;
+      FileIO::IOExecutor executor(options);
+      EXPECT_TRUE(executor.Submit(blocker));
+      while (executor.Queued() > 0) { // the thread takes the first task
+         std::this_thread::yield();
+      }
+      EXPECT_TRUE(executor.Submit(blocker));
+      EXPECT_EQ(executor.Queued(), 1);
+      EXPECT_FALSE(executor.Submit(blocker));
+
+      // rejected work completes at once with an error, on the calling thread
+      auto rejected = FileIO::ReadAsciiFileContentAsync(mTestDirectory + "/any", executor);
+      EXPECT_EQ(std::future_status::ready, rejected.wait_for(std::chrono::seconds(0)));
+      EXPECT_TRUE(rejected.get().HasFailed());
+      bool calledBack = false;
+      FileIO::RemoveFileAsync(mTestDirectory + "/any", [&](const Result<bool>& result) {
+         calledBack = result.HasFailed();
+      }, executor);
+      EXPECT_TRUE(calledBack);
+      release.set_value();
+   } // the queued task is run before the executor is gone
+   EXPECT_EQ(ran.load(), 2);
+
+   FileIO::ExecutorOptions blocking;
+   blocking.threads = 1;
+   blocking.queueCapacity = 1;
+   blocking.whenFull = FileIO::Backpressure::Block;
+   FileIO::IOExecutor executor(blocking);
+   std::atomic<size_t> count{0};
+   for (size_t index = 0; index < 100; ++index) {
+      EXPECT_TRUE(executor.Submit([&] { ++count; }));
+   }
+   auto last = FileIO::ReadAsciiFileContentAsync(mTestDirectory + "/any", executor);
+   last.wait();
+   EXPECT_EQ(count.load(), 100);
+}
+
+TEST_F(TestFileIO, IOExecutor__ExceptionsDoNotStopTheThreads) {
+   FileIO::ExecutorOptions options;
+   options.threads = 1;
+   FileIO::IOExecutor executor(options);
+   std::function<Result<bool>()> throwing = []() -> Result<bool> { throw std::runtime_error("disk on fire"); };
+
+   auto failed = FileIO::RunAsync<bool>(executor, throwing).get();
+   EXPECT_TRUE(failed.HasFailed());
+   EXPECT_NE(std::string::npos, failed.error.find("disk on fire"));
+
+   std::promise<std::string> reported;
+   FileIO::RunAsync<bool>(executor, throwing, [&](const Result<bool>& result) {
+      reported.set_value(result.error);
+   });
+   EXPECT_NE(std::string::npos, reported.get_future().get().find("disk on fire"));
+
+   FileIO::RunAsync<bool>(executor, [] { return Result<bool>{true}; }, [](const Result<bool>&) {
+      throw std::runtime_error("callback on fire");
+   });
+   EXPECT_TRUE(executor.Submit([] { throw 42; }));
+   // the thread survived all of it and still runs work
+   EXPECT_TRUE(FileIO::ReadAsciiFileContentAsync(mTestDirectory + "/any", executor).get().HasFailed());
+}
+
+// Many tiny files: ReadAsciiFileContent one by one against ReadFilesBatch
+TEST_F(TestFileIO, DISABLED_System_Performance_ReadFilesBatch__vs_ReadAsciiFileContent) {
+   std::vector<std::string> paths;
+   for (size_t index = 0; index < 5000; ++index) {
+      paths.push_back(mTestDirectory + "/tiny_" + std::to_string(index));
+      FileIO::WriteAsciiFileContent(paths.back(), "value " + std::to_string(index) + "\n");
+   }
+
+   for (int round = 0; round < 2; ++round) {
+      StopWatch timer;
+      size_t bytes = 0;
+      for (const auto& path : paths) {
+         bytes += FileIO::ReadAsciiFileContent(path).result.size();
+      }
+      std::cout << "ReadAsciiFileContent:         " << bytes << " bytes in " << timer.ElapsedMs() << " ms" << std::endl;
+
+      for (bool useIoUring : {true, false}) {
+         FileIO::BatchReadOptions options;
+         options.useIoUring = useIoUring;
+         timer.Restart();
+         bytes = 0;
+         for (const auto& result : FileIO::ReadFilesBatch(paths, options)) {
+            bytes += result.result.size();
+         }
+         std::cout << "ReadFilesBatch " << (useIoUring ? "io_uring:      " : "4 workers:     ") << bytes << " bytes in "
+                   << timer.ElapsedMs() << " ms" << std::endl;
+      }
+   }
+}
+
+namespace {
+   /// @return pages of the file that are in the page cache, from mincore
+   size_t ResidentPages(const std::string& file) {
+      FileIO::ScopedFileDescriptor descriptor(file, O_RDONLY, 0);
+      struct stat info;
+      if (-1 == descriptor.fd || 0 != fstat(descriptor.fd, &info) || 0 == info.st_size) {
+         return 0;
+      }
+      void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, descriptor.fd, 0);
+      const size_t pageSize = sysconf(_SC_PAGESIZE);
+      std::vector<unsigned char> pages((info.st_size + pageSize - 1) / pageSize);
+      size_t resident = 0;
+      if (MAP_FAILED != mapped && 0 == mincore(mapped, info.st_size, pages.data())) {
+         resident = std::count_if(pages.begin(), pages.end(), [](unsigned char page) { return page & 1; });
+      }
+      munmap(mapped, info.st_size);
+      return resident;
+   }
+
+   /// @return size bytes of a reproducible pseudo random pattern
+   std::vector<uint8_t> RandomBytes(const size_t size, const unsigned seed) {
+      std::vector<uint8_t> bytes(size);
+      std::mt19937 random(seed);
+      std::generate(bytes.begin(), bytes.end(), [&] { return static_cast<uint8_t> (random()); });
+      return bytes;
+   }
+
+   void EvictFromPageCache(const std::string& file) {
+      FileIO::ScopedFileDescriptor descriptor(file, O_RDONLY, 0);
+      fdatasync(descriptor.fd);
+      posix_fadvise(descriptor.fd, 0, 0, POSIX_FADV_DONTNEED);
+   }
+}
+
+TEST_F(TestFileIO, DirectIO__UnalignedAppendsAndReads) {
+   const std::vector<uint8_t> pattern = RandomBytes(3 * 1024 * 1024 + 4096 + 17, 7);
+
+   FileIO::IOOptions direct;
+   direct.directIO = true;
+   // ext4 under /tmp, and tmpfs under /dev/shm where there is one
+   std::vector<std::string> directories{mTestDirectory};
+   if (FileIO::DoesDirectoryExist("/dev/shm")) {
+      directories.emplace_back("/dev/shm");
+   } else {
+      SUCCEED() << "No /dev/shm, direct I/O on tmpfs is not tested";
+   }
+   for (const auto& directory : directories) {
+      const std::string file{directory + "/FileIO_direct_io_" + std::to_string(getpid()) + ".bin"};
+      ScopedFileCleanup cleanup{file};
+      std::vector<uint8_t> expected;
+      size_t offset = 0;
+      for (size_t size : {size_t{100}, size_t{5000}, size_t{0}, size_t{4096}, size_t{3 * 1024 * 1024 + 17}}) {
+         std::vector<uint8_t> chunk(pattern.begin() + offset, pattern.begin() + offset + size);
+         offset += size;
+         ASSERT_FALSE(FileIO::WriteAppendBinaryFileContentWithOptions(file, chunk, direct).HasFailed()) << file;
+         expected.insert(expected.end(), chunk.begin(), chunk.end());
+      }
+
+      auto read = FileIO::ReadBinaryFileContentWithOptions(file, direct);
+      ASSERT_FALSE(read.HasFailed()) << read.error;
+      EXPECT_TRUE(read.result == expected) << file;
+      EXPECT_TRUE(FileIO::ReadBinaryFileContent(file).result == expected) << file;
+   }
+
+   // created like every other write: 0666 minus the umask
+   const std::string created{mTestDirectory + "/direct_created.bin"};
+   const mode_t previousMask = umask(0022);
+   ASSERT_FALSE(FileIO::WriteAppendBinaryFileContentWithOptions(created, pattern, direct).HasFailed());
+   umask(0);
+   const std::string unmasked{mTestDirectory + "/direct_created_unmasked.bin"};
+   ASSERT_FALSE(FileIO::WriteAppendBinaryFileContentWithOptions(unmasked, pattern, direct).HasFailed());
+   umask(previousMask);
+   struct stat createdInfo;
+   ASSERT_EQ(0, stat(created.c_str(), &createdInfo));
+   EXPECT_EQ(0644, createdInfo.st_mode & 0777);
+   ASSERT_EQ(0, stat(unmasked.c_str(), &createdInfo));
+   EXPECT_EQ(0666, createdInfo.st_mode & 0777);
+
+   auto missing = FileIO::ReadBinaryFileContentWithOptions(mTestDirectory + "/missing", direct);
+   EXPECT_TRUE(missing.HasFailed());
+   EXPECT_EQ(missing.error, FileIO::ReadBinaryFileContent(mTestDirectory + "/missing").error);
+
+   FileIO::ScopedFileDescriptor directory(mTestDirectory, O_RDONLY | O_DIRECTORY, 0);
+   const size_t blockSize = FileIO::LogicalBlockSize(directory.fd);
+   EXPECT_GE(blockSize, 512);
+   EXPECT_EQ(0, blockSize & (blockSize - 1));
+
+   FileIO::AlignedBufferPool pool(64 * 1024, 1);
+   const uint8_t* first = nullptr;
+   {
+      auto lease = pool.Acquire();
+      first = lease.Buffer().Data();
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t> (first) % 4096);
+   }
+   EXPECT_EQ(first, pool.Acquire().Buffer().Data());
+}
+
+
+// 256MB archive written and read back, buffered and with direct I/O: throughput and page cache footprint
+TEST_F(TestFileIO, DISABLED_System_Performance_DirectIO__Throughput_and_PageCache) {
+   const std::vector<uint8_t> block(8 * 1024 * 1024 + 123, 'x');
+   const size_t kBlocks = 32;
+   for (bool directIO : {false, true}) {
+      FileIO::IOOptions options;
+      options.directIO = directIO;
+      const std::string file{mTestDirectory + "/archive.bin"};
+      const std::string name{directIO ? "direct:   " : "buffered: "};
+
+      StopWatch timer;
+      for (size_t index = 0; index < kBlocks; ++index) {
+         FileIO::WriteAppendBinaryFileContentWithOptions(file, block, options);
+      }
+      FileIO::ScopedFileDescriptor synced(file, O_RDONLY, 0);
+      fdatasync(synced.fd);
+      auto elapsedMs = std::max<uint64_t>(timer.ElapsedMs(), 1);
+      const size_t megabytes = block.size() * kBlocks / (1024 * 1024);
+      std::cout << name << "write " << megabytes * 1000 / elapsedMs << " MB/s, " << ResidentPages(file) * 4 / 1024
+                << " MB of it in the page cache" << std::endl;
+
+      EvictFromPageCache(file);
+      timer.Restart();
+      auto read = FileIO::ReadBinaryFileContentWithOptions(file, options);
+      elapsedMs = std::max<uint64_t>(timer.ElapsedMs(), 1);
+      std::cout << name << "read  " << megabytes * 1000 / elapsedMs << " MB/s, " << ResidentPages(file) * 4 / 1024
+                << " MB of it in the page cache" << std::endl;
+      FileIO::RemoveFile(file);
+   }
+}
+
+TEST_F(TestFileIO, PageCache__DropAfterReadWriteAndCopy) {
+   const std::vector<uint8_t> pattern = RandomBytes(4 * 1024 * 1024 + 17, 11);
+   const std::string file{mTestDirectory + "/cache_hygiene.bin"};
+
+   FileIO::IOOptions dropping;
+   dropping.dropAfterWrite = true;
+   dropping.dropAfterRead = true;
+   ASSERT_FALSE(FileIO::WriteAppendBinaryFileContentWithOptions(file, pattern, dropping).HasFailed());
+   EXPECT_LE(ResidentPages(file), 1) << "only the partial last page may stay";
+
+   for (auto advice : {FileIO::ReadAdvice::Normal, FileIO::ReadAdvice::Sequential, FileIO::ReadAdvice::WillNeed}) {
+      dropping.readAdvice = advice;
+      auto read = FileIO::ReadBinaryFileContentWithOptions(file, dropping);
+      ASSERT_FALSE(read.HasFailed()) << read.error;
+      EXPECT_TRUE(read.result == pattern);
+      EXPECT_LE(ResidentPages(file), 1);
+   }
+   FileIO::IOOptions hinted;
+   hinted.readAdvice = FileIO::ReadAdvice::Sequential;
+   EXPECT_TRUE(FileIO::ReadBinaryFileContentWithOptions(file, hinted).result == pattern);
+   EXPECT_GT(ResidentPages(file), 1) << "without the drop the read is cached";
+   auto missing = FileIO::ReadBinaryFileContentWithOptions(mTestDirectory + "/missing", hinted);
+   EXPECT_EQ(missing.error, FileIO::ReadBinaryFileContent(mTestDirectory + "/missing").error);
+
+   const std::string text{mTestDirectory + "/cache_hygiene.txt"};
+   const std::string lines(2 * 1024 * 1024, 'l');
+   ASSERT_FALSE(FileIO::WriteAsciiFileContentWithOptions(text, lines, dropping).HasFailed());
+   EXPECT_LE(ResidentPages(text), 1);
+   ASSERT_FALSE(FileIO::AppendWriteAsciiFileContentWithOptions(text, lines, dropping).HasFailed());
+   EXPECT_LE(ResidentPages(text), 1);
+   ASSERT_FALSE(FileIO::WriteFileAtomicallyWithOptions(text, lines, FileIO::Durability::None, dropping).HasFailed());
+   EXPECT_LE(ResidentPages(text), 1);
+   EXPECT_EQ(FileIO::ReadAsciiFileContent(text).result, lines);
+   FileIO::RemoveFile(text);
+
+   const std::string copy{mTestDirectory + "/cache_hygiene.copy"};
+   FileIO::CopyOptions options;
+   options.allowReflink = false;
+   options.dropCacheBehind = true;
+   auto copied = FileIO::CopyFile(file, copy, options);
+   ASSERT_FALSE(copied.HasFailed()) << copied.error;
+   EXPECT_TRUE(FileIO::ReadBinaryFileContent(copy).result == pattern);
+   EvictFromPageCache(copy); // the read above cached it
+   EvictFromPageCache(file);
+   auto uncached = FileIO::CopyFile(file, copy, options);
+   ASSERT_FALSE(uncached.HasFailed()) << uncached.error;
+   EXPECT_LE(ResidentPages(file), 2);
+   EXPECT_LE(ResidentPages(copy), 2);
+   FileIO::RemoveFile(file);
+   FileIO::RemoveFile(copy);
+}
+
+// 256MB file copied with and without dropping it from the page cache behind the copy
+TEST_F(TestFileIO, DISABLED_System_Performance_CopyFile__DropCacheBehind) {
+   const std::string file{mTestDirectory + "/copy_source.bin"};
+   const std::vector<uint8_t> block(8 * 1024 * 1024, 'x');
+   for (size_t index = 0; index < 32; ++index) {
+      FileIO::WriteAppendBinaryFileContent(file, block);
+   }
+   for (bool dropCacheBehind : {false, true}) {
+      EvictFromPageCache(file);
+      FileIO::CopyOptions options;
+      options.allowReflink = false;
+      options.dropCacheBehind = dropCacheBehind;
+      const std::string copy{mTestDirectory + "/copy_dest.bin"};
+      StopWatch timer;
+      FileIO::CopyFile(file, copy, options);
+      FileIO::ScopedFileDescriptor synced(copy, O_RDONLY, 0);
+      fdatasync(synced.fd);
+      auto elapsedMs = std::max<uint64_t>(timer.ElapsedMs(), 1);
+      std::cout << (dropCacheBehind ? "drop behind: " : "cached:      ") << 256 * 1000 / elapsedMs << " MB/s, "
+                << (ResidentPages(file) + ResidentPages(copy)) * 4 / 1024 << " MB in the page cache" << std::endl;
+      FileIO::RemoveFile(copy);
+   }
+   FileIO::RemoveFile(file);
+}
+
+namespace {
+   /// @return bytes of disk blocks allocated to the file, reserved ones included
+   size_t AllocatedBytes(const std::string& file) {
+      struct stat info;
+      return (0 == stat(file.c_str(), &info)) ? static_cast<size_t> (info.st_blocks) * 512 : 0;
+   }
+
+   /// @return number of extents of the file, from FIEMAP
+   size_t Extents(const std::string& file) {
+      FileIO::ScopedFileDescriptor descriptor(file, O_RDONLY, 0);
+      struct fiemap map{};
+      map.fm_length = FIEMAP_MAX_OFFSET;
+      map.fm_flags = FIEMAP_FLAG_SYNC;
+      return (0 == ioctl(descriptor.fd, FS_IOC_FIEMAP, &map)) ? map.fm_mapped_extents : 0;
+   }
+}
+
+TEST_F(TestFileIO, Preallocate__FileAppendersAndCopy) {
+   const size_t kMegabyte = 1024 * 1024;
+   const std::string file{mTestDirectory + "/preallocated.bin"};
+   ASSERT_FALSE(FileIO::PreallocateFile(file, kMegabyte).HasFailed());
+   EXPECT_EQ(0, FileIO::ReadBinaryFileContent(file).result.size());
+   EXPECT_GE(AllocatedBytes(file), kMegabyte);
+   ASSERT_FALSE(FileIO::PreallocateFile(file, 2 * kMegabyte, FileIO::PreallocateMode::Extend).HasFailed());
+   EXPECT_TRUE(FileIO::ReadBinaryFileContent(file).result == std::vector<uint8_t>(2 * kMegabyte, 0));
+   EXPECT_TRUE(FileIO::PreallocateFile("/xyz/*&%/x.y.z", kMegabyte).HasFailed());
+   FileIO::RemoveFile(file);
+
+   const std::vector<uint8_t> record(100, 'r');
+   FileIO::AppenderOptions appenderOptions;
+   appenderOptions.flushBytes = 4096;
+   appenderOptions.preallocateBytes = kMegabyte;
+   {
+      FileIO::BinaryAppender appender(file, appenderOptions);
+      for (size_t index = 0; index < 100; ++index) {
+         ASSERT_FALSE(appender.Append(record).HasFailed());
+      }
+      ASSERT_FALSE(appender.Flush().HasFailed());
+      EXPECT_GE(AllocatedBytes(file), kMegabyte);
+   }
+   EXPECT_LT(AllocatedBytes(file), kMegabyte) << "the unused reservation is released at close";
+   EXPECT_EQ(100 * record.size(), FileIO::ReadBinaryFileContent(file).result.size());
+   FileIO::RemoveFile(file);
+
+   for (bool directIO : {false, true}) {
+      FileIO::IOOptions ioOptions;
+      ioOptions.preallocateBytes = kMegabyte;
+      ioOptions.directIO = directIO;
+      std::vector<uint8_t> expected;
+      for (size_t index = 0; index < 10; ++index) {
+         ASSERT_FALSE(FileIO::WriteAppendBinaryFileContentWithOptions(file, record, ioOptions).HasFailed());
+         expected.insert(expected.end(), record.begin(), record.end());
+      }
+      EXPECT_GE(AllocatedBytes(file), kMegabyte) << directIO;
+      EXPECT_TRUE(FileIO::ReadBinaryFileContent(file).result == expected) << directIO;
+      FileIO::RemoveFile(file);
+   }
+
+   // the ascii and the atomic writes reserve the space through their own descriptor
+   FileIO::IOOptions asciiOptions;
+   asciiOptions.preallocateBytes = kMegabyte;
+   const std::string line(100, 'a');
+   ASSERT_FALSE(FileIO::WriteAsciiFileContentWithOptions(file, line, asciiOptions).HasFailed());
+   EXPECT_GE(AllocatedBytes(file), kMegabyte);
+   EXPECT_EQ(line, FileIO::ReadAsciiFileContent(file).result);
+   ASSERT_FALSE(FileIO::WriteAsciiFileContentWithOptions(file, line, FileIO::IOOptions{}).HasFailed());
+   EXPECT_LT(AllocatedBytes(file), kMegabyte) << "the truncating write releases the reservation";
+   FileIO::RemoveFile(file);
+
+   for (size_t index = 0; index < 10; ++index) {
+      ASSERT_FALSE(FileIO::AppendWriteAsciiFileContentWithOptions(file, line, asciiOptions).HasFailed());
+   }
+   EXPECT_GE(AllocatedBytes(file), kMegabyte);
+   EXPECT_EQ(10 * line.size(), FileIO::ReadAsciiFileContent(file).result.size());
+   FileIO::RemoveFile(file);
+
+   ASSERT_FALSE(FileIO::WriteFileAtomicallyWithOptions(file, line, FileIO::Durability::None, asciiOptions).HasFailed());
+   EXPECT_GE(AllocatedBytes(file), kMegabyte);
+   EXPECT_EQ(line, FileIO::ReadAsciiFileContent(file).result);
+   FileIO::RemoveFile(file);
+
+   const std::string source{mTestDirectory + "/copy_source.bin"};
+   const std::string copy{mTestDirectory + "/copy_dest.bin"};
+   const std::vector<uint8_t> content = RandomBytes(3 * kMegabyte + 17, 13);
+   ASSERT_FALSE(FileIO::WriteAppendBinaryFileContent(source, content).HasFailed());
+   FileIO::CopyOptions copyOptions;
+   copyOptions.allowReflink = false;
+   auto copied = FileIO::CopyFile(source, copy, copyOptions);
+   ASSERT_FALSE(copied.HasFailed()) << copied.error;
+   EXPECT_TRUE(FileIO::ReadBinaryFileContent(copy).result == content);
+   EXPECT_LT(AllocatedBytes(copy), content.size() + kMegabyte) << "nothing is reserved past the end";
+   FileIO::RemoveFile(source);
+   FileIO::RemoveFile(copy);
+}
+
+// two files appended in turns, 4KB at a time, with and without preallocation: extents per file
+TEST_F(TestFileIO, DISABLED_System_Performance_Preallocate__InterleavedAppends) {
+   const std::vector<uint8_t> record(4096, 'x');
+   const size_t kRecords = 16 * 1024;
+   for (size_t preallocateBytes : {size_t{0}, size_t{64 * 1024 * 1024}}) {
+      const std::string first{mTestDirectory + "/interleaved_1.bin"};
+      const std::string second{mTestDirectory + "/interleaved_2.bin"};
+      StopWatch timer;
+      {
+         FileIO::AppenderOptions options;
+         options.flushBytes = record.size();
+         options.syncPolicy = FileIO::SyncPolicy::EveryNBytes;
+         options.syncBytes = 1024 * 1024;
+         options.preallocateBytes = preallocateBytes;
+         FileIO::BinaryAppender one(first, options);
+         FileIO::BinaryAppender two(second, options);
+         for (size_t index = 0; index < kRecords; ++index) {
+            one.Append(record);
+            two.Append(record);
+         }
+      }
+      const auto elapsedMs = timer.ElapsedMs();
+      std::cout << (preallocateBytes ? "preallocated: " : "plain:        ") << Extents(first) << " and " << Extents(second)
+                << " extents, " << elapsedMs << " ms" << std::endl;
+      FileIO::RemoveFile(first);
+      FileIO::RemoveFile(second);
+   }
+}
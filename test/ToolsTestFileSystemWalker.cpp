@@ -1,5 +1,9 @@
 #include "ToolsTestFileSystemWalker.h"
 #include "FileSystemWalker.h"
+#include "ParallelFileSystemWalker.h"
+#include "WalkRange.h"
+#include "TreeUsage.h"
+#include "TreeSnapshot.h"
 #include "Result.h"
 #include <vector>
 #include <string>
@@ -8,6 +12,12 @@
 #include <thread>
 #include <future>
 #include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 
 namespace {
@@ -215,7 +225,526 @@ TEST_F(ToolsTestFileSystemWalker, ThreeDirectoriesThreeFiles_100Threads) {
 
 
 
+TEST_F(ToolsTestFileSystemWalker, NoStat_FilesAreNotStatedUntilAsked) {
+   auto dir1 = CreateSubDirectory("dir1");
+   CreateFile(dir1, "file_1");
+   CreateFile(dir1, "file_2");
+   ASSERT_EQ(0, symlink("file_1", std::string{dir1 + "/link"}.c_str()));
+
+   size_t notStated = 0;
+   size_t regularFiles = 0;
+   size_t directories = 0;
+   auto handler = [&](FTSENT* node, int flag) {
+      struct stat info;
+      EXPECT_TRUE(FileSystemWalker::Stat(node, info)) << node->fts_path;
+      notStated += (FTS_NSOK == flag) ? 1 : 0;
+      regularFiles += S_ISREG(info.st_mode) ? 1 : 0;
+      directories += (FTS_D == flag && S_ISDIR(info.st_mode)) ? 1 : 0;
+      return 0;
+   };
+
+   WalkOptions options;
+   options.noStat = true;
+   FileSystemWalker walker(mTestDirectory, handler, options);
+   EXPECT_FALSE(walker.Action().HasFailed());
+   EXPECT_EQ(notStated, 3);  // the files and the symbolic link
+   EXPECT_EQ(regularFiles, 2);
+   EXPECT_EQ(directories, 2);
+}
+
+TEST_F(ToolsTestFileSystemWalker, SkipSubtree_PrunesFromTheHandler) {
+   CreateSubDirectory("dir1/dir2");
+   CreateSubDirectory("dir3");
+   CreateFile({mTestDirectory + "/dir1"}, {"file_1"});
+   CreateFile({mTestDirectory + "/dir1/dir2"}, {"file_2"});
+   CreateFile({mTestDirectory + "/dir3"}, {"file_3"});
+
+   std::vector<std::string> names;
+   auto handler = [&](FTSENT* node, int flag) {
+      if (FTS_DP != flag) {
+         names.push_back(node->fts_name);
+      }
+      if (FTS_D == flag && std::string{"dir1"} == node->fts_name) {
+         FileSystemWalker::SkipSubtree(node);
+      }
+      return 0;
+   };
+
+   FileSystemWalker walker(mTestDirectory, handler);
+   EXPECT_FALSE(walker.Action().HasFailed());
+   std::sort(names.begin(), names.end());
+   EXPECT_EQ(names, (std::vector<std::string>{"TempFileSystemWalker", "dir1", "dir3", "file_3"}));
+
+   // the same for the parallel walker
+   std::mutex lock;
+   names.clear();
+   auto factory = [&]() -> ParallelFileSystemWalker::FtsHandler {
+      return [&](FTSENT* node, int flag) {
+         std::lock_guard<std::mutex> guard(lock);
+         return handler(node, flag);
+      };
+   };
+   ParallelFileSystemWalker parallelWalker(mTestDirectory, factory, 4);
+   EXPECT_FALSE(parallelWalker.Action().HasFailed());
+   std::sort(names.begin(), names.end());
+   EXPECT_EQ(names, (std::vector<std::string>{"TempFileSystemWalker", "dir1", "dir3", "file_3"}));
+}
+
+TEST_F(ToolsTestFileSystemWalker, WalkRange_DepthAndOrder) {
+   CreateSubDirectory("dir1/dir2");
+   CreateFile({mTestDirectory + "/dir1"}, {"file_1"});
+   CreateFile({mTestDirectory + "/dir1/dir2"}, {"file_2"});
+
+   auto Names = [&](const WalkOptions& options) {
+      std::vector<std::string> names;
+      WalkCursor cursor(mTestDirectory, options);
+      EXPECT_FALSE(cursor.Valid().HasFailed());
+      for (FTSENT& entry : MakeWalkRange(cursor)) {
+         names.push_back(std::string{FTS_DP == entry.fts_info ? "post:" : ""} + entry.fts_name);
+      }
+      return names;
+   };
+
+   WalkOptions options;
+   options.maxDepth = 1;
+   EXPECT_EQ(Names(options), (std::vector<std::string>{"TempFileSystemWalker", "dir1", "post:dir1", "post:TempFileSystemWalker"}));
+
+   options.maxDepth = -1;
+   options.order = WalkOrder::PreOrder;
+   auto preOrder = Names(options);
+   std::sort(preOrder.begin() + 2, preOrder.end());
+   EXPECT_EQ(preOrder, (std::vector<std::string>{"TempFileSystemWalker", "dir1", "dir2", "file_1", "file_2"}));
+
+   options.order = WalkOrder::PostOrder;
+   auto postOrder = Names(options);
+   EXPECT_EQ(postOrder.size(), 5);
+   EXPECT_EQ(postOrder.back(), "post:TempFileSystemWalker");
+   auto isPostOrder = [](const std::string& name) { return 0 == name.find("post:"); };
+   EXPECT_EQ(std::count_if(postOrder.begin(), postOrder.end(), isPostOrder), 3);
+
+   WalkCursor invalid("/this/path/does/not/exist");
+   EXPECT_TRUE(invalid.Valid().HasFailed());
+   EXPECT_EQ(nullptr, invalid.Next());
+}
+
+TEST_F(ToolsTestFileSystemWalker, WalkRange_ResumeFilterAndAlgorithms) {
+   CreateSubDirectory("dir1");
+   CreateSubDirectory("dir2");
+   CreateFile({mTestDirectory + "/dir1"}, {"file_1"});
+   CreateFile({mTestDirectory + "/dir1"}, {"file_2"});
+   CreateFile({mTestDirectory + "/dir2"}, {"file_3"});
+
+   // break out at the first file, the next loop continues after it
+   WalkCursor cursor(mTestDirectory);
+   auto files = MakeWalkRange(cursor, [](const FTSENT& entry) { return FTS_F == entry.fts_info; });
+   std::vector<std::string> names;
+   for (FTSENT& entry : files) {
+      names.push_back(entry.fts_name);
+      break;
+   }
+   ASSERT_EQ(names.size(), 1);
+   EXPECT_EQ(names.back(), cursor.Current()->fts_name);
+   for (FTSENT& entry : files) {
+      names.push_back(entry.fts_name);
+   }
+   std::sort(names.begin(), names.end());
+   EXPECT_EQ(names, (std::vector<std::string>{"file_1", "file_2", "file_3"}));
+   EXPECT_EQ(nullptr, cursor.Next());
+
+   // standard algorithms and pruning
+   WalkCursor counting(mTestDirectory);
+   auto all = MakeWalkRange(counting);
+   auto count = std::count_if(all.begin(), all.end(), [](FTSENT& entry) {
+      if (FTS_D == entry.fts_info && std::string{"dir1"} == entry.fts_name) {
+         FileSystemWalker::SkipSubtree(&entry);
+      }
+      return FTS_F == entry.fts_info;
+   });
+   EXPECT_EQ(count, 1);
+}
+
+// The same name only walk of /usr with FileSystemWalker and with a WalkRange
+TEST_F(ToolsTestFileSystemWalker, DISABLED_System_Performance_FileSystemWalker__vs_WalkRange) {
+   const std::string path{"/usr"};
+   WalkOptions options;
+   options.noStat = true;
+   for (int round = 0; round < 2; ++round) {
+      size_t entries = 0;
+      auto start = std::chrono::steady_clock::now();
+      FileSystemWalker walker(path, [&](FTSENT*, int) { ++entries; return 0; }, options);
+      walker.Action();
+      auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "FileSystemWalker: " << entries << " entries in " << elapsedMs << " ms" << std::endl;
+
+      entries = 0;
+      start = std::chrono::steady_clock::now();
+      WalkCursor cursor(path, options);
+      for (FTSENT& entry : MakeWalkRange(cursor)) {
+         (void)entry;
+         ++entries;
+      }
+      elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "WalkRange: " << entries << " entries in " << elapsedMs << " ms" << std::endl;
+   }
+}
+
+// Name only walk of /usr with and without WalkOptions::noStat
+TEST_F(ToolsTestFileSystemWalker, DISABLED_System_Performance_FileSystemWalker__NoStat) {
+   const std::string path{"/usr"};
+   for (bool noStat : {false, true, false, true}) {
+      size_t entries = 0;
+      WalkOptions options;
+      options.noStat = noStat;
+      auto start = std::chrono::steady_clock::now();
+      FileSystemWalker walker(path, [&](FTSENT*, int) { ++entries; return 0; }, options);
+      walker.Action();
+      auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "FileSystemWalker noStat=" << noStat << ": " << entries << " entries in " << elapsedMs << " ms" << std::endl;
+   }
+}
+
+namespace {
+   /// Collects the entries of every thread's handler of a ParallelFileSystemWalker
+   struct ParallelHelper {
+      std::mutex lock;
+      std::vector<std::unique_ptr<FtsHelper>> helpers;
+      std::vector<std::string> order; ///< fts_path in the order they were handled, across threads
+
+      ParallelFileSystemWalker::HandlerFactory Factory() {
+         return [this]() -> ParallelFileSystemWalker::FtsHandler {
+            std::lock_guard<std::mutex> guard(lock);
+            helpers.emplace_back(new FtsHelper);
+            FtsHelper* helper = helpers.back().get();
+            return [this, helper](FTSENT* ptr, int flag) {
+               {
+                  std::lock_guard<std::mutex> guard(lock);
+                  order.push_back(ptr->fts_path);
+               }
+               // the depth below the start path is correct also for split off subtrees
+               EXPECT_EQ(ptr->fts_level, std::count(ptr->fts_path + strlen("/tmp/TempFileSystemWalker"), ptr->fts_path + ptr->fts_pathlen, '/'));
+               return helper->FtsHelperAction(ptr, flag);
+            };
+         };
+      }
+
+      size_t Count(size_t FtsHelper::*counter) const {
+         size_t total = 0;
+         for (const auto& helper : helpers) {
+            total += (*helper).*counter;
+         }
+         return total;
+      }
+   };
+}
+
+TEST_F(ToolsTestFileSystemWalker, Parallel_Invalid) {
+   ParallelHelper helper;
+   ParallelFileSystemWalker walker("/xyx/Does/Not/Exist", helper.Factory(), 4);
+   EXPECT_FALSE(walker.IsValid());
+   EXPECT_TRUE(walker.Action().HasFailed());
+}
+
+TEST_F(ToolsTestFileSystemWalker, Parallel_EveryEntryOnce) {
+   size_t files = 0;
+   size_t directories = 1; // the start path
+   for (size_t branch = 0; branch < 8; ++branch) {
+      std::string path{"branch" + std::to_string(branch)};
+      for (size_t depth = 0; depth < 5; ++depth) {
+         path += "/level" + std::to_string(depth);
+         const std::string directory = CreateSubDirectory(path);
+         ++directories;
+         for (size_t file = 0; file < 3; ++file) {
+            CreateFile(directory, "file_" + std::to_string(file));
+            ++files;
+         }
+      }
+      ++directories; // branchN, created by mkdir -p
+   }
+
+   for (size_t threads : {1, 4, 16}) {
+      ParallelHelper helper;
+      ParallelFileSystemWalker walker(mTestDirectory, helper.Factory(), threads);
+      auto result = walker.Action();
+      EXPECT_FALSE(result.HasFailed()) << result.error;
+      EXPECT_EQ(result.result, 0);
+
+      EXPECT_EQ(helper.Count(&FtsHelper::fileCounter), files);
+      EXPECT_EQ(helper.Count(&FtsHelper::directoryCounter), directories);
+      EXPECT_EQ(helper.Count(&FtsHelper::ignoredCounter), directories); // FTS_D, once per directory
+
+      std::vector<std::string> all;
+      for (const auto& single : helper.helpers) {
+         all.insert(all.end(), single->rootNames.begin(), single->rootNames.end());
+      }
+      std::sort(all.begin(), all.end());
+      EXPECT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end()) << "an entry was handled twice";
+      ASSERT_FALSE(helper.order.empty());
+      EXPECT_EQ(helper.order.back(), mTestDirectory); // the FTS_DP of the start path is last
+      EXPECT_LE(helper.helpers.size(), threads + 1);
+   }
+}
+
+TEST_F(ToolsTestFileSystemWalker, Parallel_StopsWhenHandlerReturnsNonZero) {
+   for (size_t directory = 0; directory < 20; ++directory) {
+      const std::string path = CreateSubDirectory("dir" + std::to_string(directory));
+      CreateFile(path, "file");
+   }
+
+   std::atomic<size_t> handled{0};
+   auto factory = [&]() -> ParallelFileSystemWalker::FtsHandler {
+      return [&](FTSENT*, int flag) {
+         ++handled;
+         return (FTS_F == flag) ? 42 : 0;
+      };
+   };
+   ParallelFileSystemWalker walker(mTestDirectory, factory, 4);
+   auto result = walker.Action();
+   EXPECT_EQ(result.result, 42);
+   EXPECT_LT(handled, 60); // 20 files + 40 directory visits if it did not stop
+}
+
+// Walking /usr with FileSystemWalker vs ParallelFileSystemWalker with 1 -> 16 threads
+TEST_F(ToolsTestFileSystemWalker, DISABLED_System_Performance_FileSystemWalker__vs_ParallelFileSystemWalker) {
+   const std::string path{"/usr"};
+   size_t entries = 0;
+   auto start = std::chrono::steady_clock::now();
+   FileSystemWalker walker(path, [&](FTSENT*, int) { ++entries; return 0; });
+   walker.Action();
+   auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "FileSystemWalker:                      " << entries << " entries in " << elapsedMs << " ms" << std::endl;
+
+   for (size_t threads : {1, 2, 4, 8, 16}) {
+      std::atomic<size_t> parallelEntries{0};
+      auto factory = [&]() -> ParallelFileSystemWalker::FtsHandler {
+         return [&](FTSENT*, int) { ++parallelEntries; return 0; };
+      };
+      start = std::chrono::steady_clock::now();
+      ParallelFileSystemWalker parallelWalker(path, factory, threads);
+      parallelWalker.Action();
+      elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "ParallelFileSystemWalker " << threads << " threads:\t" << parallelEntries << " entries in " << elapsedMs << " ms" << std::endl;
+   }
+}
+
 // TEST_F(ToolsTestFileSystemWalker, CountFilesRecursive) {
    
 //    size_t fileCounter = 0;
 // }
+
+TEST_F(ToolsTestFileSystemWalker, TreeUsage_RollupsAndHardLinks) {
+   CreateSubDirectory("dir1/dir2");
+   CreateSubDirectory("dir3");
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/dir1/file_1", std::string(1000, 'a')).HasFailed());
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/dir1/dir2/file_2", std::string(5000, 'b')).HasFailed());
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(mTestDirectory + "/dir3/file_3", std::string(300, 'c')).HasFailed());
+   EXPECT_EQ(0, link((mTestDirectory + "/dir1/dir2/file_2").c_str(), (mTestDirectory + "/dir3/link_2").c_str()));
+   EXPECT_EQ(0, symlink("file_3", (mTestDirectory + "/dir3/symlink_3").c_str()));
+
+   for (size_t threads : {1, 4}) {
+      FileIO::UsageOptions options;
+      options.threads = threads;
+      options.maxDepth = 1;
+      auto result = FileIO::ComputeTreeUsage(mTestDirectory + "/", options);
+      ASSERT_FALSE(result.HasFailed()) << result.error;
+      const FileIO::TreeUsage& usage = result.result;
+      EXPECT_EQ(usage.total.files, 3);
+      EXPECT_EQ(usage.total.directories, 4);
+      EXPECT_EQ(usage.total.others, 1);
+      EXPECT_EQ(usage.unreadable, 0);
+
+      EXPECT_EQ(usage.directories.size(), 3);
+      ASSERT_EQ(usage.directories.count(mTestDirectory + "/dir1"), 1);
+      ASSERT_EQ(usage.directories.count(mTestDirectory + "/dir3"), 1);
+      const auto& dir1 = usage.directories.at(mTestDirectory + "/dir1");
+      const auto& dir3 = usage.directories.at(mTestDirectory + "/dir3");
+      EXPECT_EQ(dir1.directories, 2);
+      EXPECT_EQ(dir1.files + dir3.files, 3); // the hard link is counted in one of them
+      EXPECT_EQ(dir3.others, 1);
+      const auto& root = usage.directories.at(mTestDirectory);
+      EXPECT_EQ(root.allocatedBytes, usage.total.allocatedBytes);
+      EXPECT_GT(root.apparentBytes, dir1.apparentBytes + dir3.apparentBytes); // the start path's own size
+      EXPECT_GE(usage.total.apparentBytes, 6300);
+      EXPECT_LT(usage.total.apparentBytes, 6300 + 4 * 1024 * 1024);
+
+      // du counts hard links once as well
+      std::string du{"du -s -B1 " + mTestDirectory + " | cut -f1 > " + mTestDirectory + ".du"};
+      ASSERT_EQ(0, system(du.c_str()));
+      auto duBytes = FileIO::ReadAsciiFileContent(mTestDirectory + ".du");
+      EXPECT_EQ(std::to_string(usage.total.allocatedBytes) + "\n", duBytes.result);
+      unlink((mTestDirectory + ".du").c_str());
+   }
+
+   FileIO::UsageOptions everyDirectory;
+   everyDirectory.maxDepth = -1;
+   auto result = FileIO::ComputeTreeUsage(mTestDirectory, everyDirectory);
+   ASSERT_FALSE(result.HasFailed());
+   EXPECT_EQ(result.result.directories.size(), 4);
+   ASSERT_EQ(result.result.directories.count(mTestDirectory + "/dir1/dir2"), 1);
+   EXPECT_EQ(result.result.directories.at(mTestDirectory + "/dir1/dir2").directories, 1);
+
+   auto invalid = FileIO::ComputeTreeUsage("/this/path/does/not/exist");
+   EXPECT_TRUE(invalid.HasFailed());
+}
+
+// ComputeTreeUsage against du on the same tree
+TEST_F(ToolsTestFileSystemWalker, DISABLED_System_Performance_TreeUsage__vs_du) {
+   const std::string path{"/usr"};
+   for (int round = 0; round < 2; ++round) {
+      auto start = std::chrono::steady_clock::now();
+      ASSERT_EQ(0, system(("du -sx " + path + " > /dev/null").c_str()));
+      auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "du -sx: " << elapsedMs << " ms" << std::endl;
+
+      for (size_t threads : {1, 4}) {
+         FileIO::UsageOptions options;
+         options.threads = threads;
+         start = std::chrono::steady_clock::now();
+         auto usage = FileIO::ComputeTreeUsage(path, options);
+         elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+         std::cout << "ComputeTreeUsage threads=" << threads << ": " << usage.result.total.allocatedBytes
+                 << " bytes in " << elapsedMs << " ms" << std::endl;
+      }
+   }
+}
+
+namespace {
+   /// Moves the modification time an hour back, out of the snapshot's racy window
+   void MakeOld(const std::string& path) {
+      struct timespec times[2];
+      times[0].tv_sec = time(nullptr) - 3600;
+      times[0].tv_nsec = 0;
+      times[1] = times[0];
+      EXPECT_EQ(0, utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW));
+   }
+
+   std::vector<std::string> Describe(const std::vector<FileIO::TreeChange>& changes) {
+      std::vector<std::string> described;
+      for (const auto& change : changes) {
+         const char* what = (FileIO::ChangeType::Added == change.change) ? "added " :
+                 (FileIO::ChangeType::Removed == change.change) ? "removed " : "modified ";
+         described.push_back(what + change.path);
+      }
+      std::sort(described.begin(), described.end());
+      return described;
+   }
+}
+
+TEST_F(ToolsTestFileSystemWalker, TreeSnapshot_Changes) {
+   CreateSubDirectory("dir1/dir2");
+   CreateSubDirectory("dir3");
+   CreateFile({mTestDirectory + "/dir1"}, {"file_1"});
+   CreateFile({mTestDirectory + "/dir1/dir2"}, {"file_2"});
+   CreateFile({mTestDirectory + "/dir3"}, {"file_3"});
+   for (const std::string directory : {"", "/dir1", "/dir1/dir2", "/dir3"}) {
+      MakeOld(mTestDirectory + directory);
+   }
+
+   FileIO::TreeSnapshot snapshot;
+   EXPECT_TRUE(snapshot.Update().HasFailed());
+   ASSERT_FALSE(snapshot.Take(mTestDirectory).HasFailed());
+   EXPECT_EQ(snapshot.Entries(), 7);
+   auto unchanged = snapshot.Update();
+   ASSERT_FALSE(unchanged.HasFailed());
+   EXPECT_TRUE(unchanged.result.empty());
+
+   // an in-place write does not change the directory: only found when files are stat'ed
+   EXPECT_FALSE(FileIO::AppendWriteAsciiFileContent(mTestDirectory + "/dir3/file_3", "more").HasFailed());
+   FileIO::SnapshotOptions directoriesOnly;
+   directoriesOnly.statFiles = false;
+   auto notFound = snapshot.Update(directoriesOnly);
+   ASSERT_FALSE(notFound.HasFailed());
+   EXPECT_TRUE(notFound.result.empty());
+   auto modified = snapshot.Update();
+   ASSERT_FALSE(modified.HasFailed());
+   EXPECT_EQ(Describe(modified.result), (std::vector<std::string>{"modified dir3/file_3"}));
+
+   CreateSubDirectory("dir3/dir4");
+   CreateFile({mTestDirectory + "/dir3/dir4"}, {"file_4"});
+   CreateFile({mTestDirectory + "/dir1"}, {"file_5"});
+   FileIO::CleanDirectory(mTestDirectory + "/dir1/dir2", true);
+   auto changed = snapshot.Update(directoriesOnly);
+   ASSERT_FALSE(changed.HasFailed());
+   EXPECT_EQ(Describe(changed.result), (std::vector<std::string>{"added dir1/file_5", "added dir3/dir4", "added dir3/dir4/file_4",
+                                                                   "removed dir1/dir2", "removed dir1/dir2/file_2"}));
+   EXPECT_EQ(snapshot.Entries(), 8);
+
+   // the saved snapshot finds the same changes as the one in memory
+   const std::string saved{mTestDirectory + ".snapshot"};
+   ASSERT_FALSE(snapshot.Save(saved).HasFailed());
+   FileIO::TreeSnapshot loaded;
+   ASSERT_FALSE(loaded.Load(saved).HasFailed());
+   EXPECT_EQ(loaded.Root(), mTestDirectory);
+   EXPECT_EQ(loaded.Entries(), 8);
+   FileIO::RemoveFile(mTestDirectory + "/dir3/dir4/file_4");
+   EXPECT_EQ(Describe(loaded.Update().result), (std::vector<std::string>{"removed dir3/dir4/file_4"}));
+   EXPECT_EQ(Describe(snapshot.Update().result), (std::vector<std::string>{"removed dir3/dir4/file_4"}));
+
+   EXPECT_FALSE(FileIO::WriteAsciiFileContent(saved, "FIOSNAP1 truncated").HasFailed());
+   EXPECT_TRUE(loaded.Load(saved).HasFailed());
+   EXPECT_EQ(loaded.Entries(), 0);
+   FileIO::RemoveFile(saved);
+}
+
+TEST_F(ToolsTestFileSystemWalker, TreeSnapshot_LoadRejectsCorruptFiles) {
+   CreateSubDirectory("snap");
+   const std::string name{"file_1"};
+   CreateFile({mTestDirectory + "/snap"}, name);
+   FileIO::TreeSnapshot snapshot;
+   ASSERT_FALSE(snapshot.Take(mTestDirectory + "/snap").HasFailed());
+   const std::string saved{mTestDirectory + "/snap.snapshot"};
+   ASSERT_FALSE(snapshot.Save(saved).HasFailed());
+   const std::vector<uint8_t> valid = FileIO::ReadBinaryFileContent(saved).result;
+
+   // the file is the last record: hashes, inode, size, time, type, name length, name
+   const size_t recordSize = 5 * sizeof (uint64_t) + sizeof (uint8_t) + sizeof (uint16_t) + name.size();
+   const size_t countOffset = 8 + sizeof (int64_t) + sizeof (uint32_t) + snapshot.Root().size();
+   ASSERT_GT(valid.size(), countOffset + recordSize);
+
+   std::vector<uint8_t> duplicate{valid};
+   duplicate.insert(duplicate.end(), valid.end() - recordSize, valid.end());
+   uint64_t count = 0;
+   memcpy(&count, duplicate.data() + countOffset, sizeof (count));
+   ++count;
+   memcpy(duplicate.data() + countOffset, &count, sizeof (count));
+
+   std::vector<uint8_t> badType{valid};
+   badType[valid.size() - name.size() - sizeof (uint16_t) - sizeof (uint8_t)] = 99;
+
+   FileIO::TreeSnapshot loaded;
+   ASSERT_FALSE(loaded.Load(saved).HasFailed());
+   EXPECT_EQ(loaded.Entries(), 2);
+   for (const auto& corrupt : {duplicate, badType}) {
+      FileIO::RemoveFile(saved);
+      ASSERT_FALSE(FileIO::WriteAppendBinaryFileContent(saved, corrupt).HasFailed());
+      EXPECT_TRUE(loaded.Load(saved).HasFailed());
+      EXPECT_EQ(loaded.Entries(), 0);
+      EXPECT_TRUE(loaded.Update().HasFailed());
+   }
+   FileIO::RemoveFile(saved);
+}
+
+// Poll of an unchanged tree: a full walk against an Update of a snapshot
+TEST_F(ToolsTestFileSystemWalker, DISABLED_System_Performance_TreeSnapshot__Update) {
+   const std::string path{"/usr"};
+   FileIO::TreeSnapshot snapshot;
+   auto start = std::chrono::steady_clock::now();
+   snapshot.Take(path);
+   auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "Take: " << snapshot.Entries() << " entries in " << elapsedMs << " ms" << std::endl;
+
+   for (bool statFiles : {true, false}) {
+      FileIO::SnapshotOptions options;
+      options.statFiles = statFiles;
+      start = std::chrono::steady_clock::now();
+      auto changes = snapshot.Update(options);
+      elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "Update statFiles=" << statFiles << ": " << changes.result.size() << " changes in " << elapsedMs << " ms" << std::endl;
+   }
+
+   size_t entries = 0;
+   start = std::chrono::steady_clock::now();
+   FileSystemWalker walker(path, [&](FTSENT*, int) { ++entries; return 0; });
+   walker.Action();
+   elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "FileSystemWalker: " << entries << " entries in " << elapsedMs << " ms" << std::endl;
+}